@@ -32,6 +32,15 @@ else
 	additional_args+=(-lgdi32)
 fi
 
+declare -a headless_args
+
+# worker pools wait with WaitOnAddress (futex.hpp)
+if [[ $OS == Windows_NT ]]; then
+	headless_args+=(-D_WIN32_WINNT=0x0602)
+	headless_args+=(-DNOMINMAX)
+	headless_args+=(-lsynchronization)
+fi
+
 clang++ \
 	-std=c++2b \
 	-nostdinc++ \
@@ -39,6 +48,7 @@ clang++ \
 	-Wextra \
 	-Wno-vla-cxx-extension \
 	-g \
+	-pthread \
 	-I ${root}/../core/include \
 	-I ${root}/../encoding/include \
 	-I ${root}/../math/include \
@@ -51,4 +61,106 @@ clang++ \
 	${root}/src/main.cpp \
 	-lpng \
 	-lz \
-	${additional_args[@]}
\ No newline at end of file
+	${additional_args[@]}
+
+clang++ \
+	-std=c++2b \
+	-nostdinc++ \
+	-Wall \
+	-Wextra \
+	-Wno-vla-cxx-extension \
+	-g \
+	-O3 \
+	-march=native \
+	-pthread \
+	-I ${root}/../core/include \
+	-I ${root}/../encoding/include \
+	-I ${root}/../posix-wrapper/include \
+	-I ${root}/../windows-wrapper/include \
+	-I ${root}/../print/include \
+	-o ${root}/build/2048-headless \
+	${root}/src/headless.cpp \
+	-lz \
+	${headless_args[@]}
+
+clang++ \
+	-std=c++2b \
+	-nostdinc++ \
+	-Wall \
+	-Wextra \
+	-Wno-vla-cxx-extension \
+	-g \
+	-O3 \
+	-march=native \
+	-pthread \
+	-I ${root}/../core/include \
+	-I ${root}/../encoding/include \
+	-I ${root}/../posix-wrapper/include \
+	-I ${root}/../windows-wrapper/include \
+	-I ${root}/../print/include \
+	-o ${root}/build/2048-analyze \
+	${root}/src/analyze.cpp
+
+if [[ $OS != Windows_NT ]]; then
+	clang++ \
+		-std=c++2b \
+		-nostdinc++ \
+		-Wall \
+		-Wextra \
+		-Wno-vla-cxx-extension \
+		-g \
+		-O3 \
+		-march=native \
+		-pthread \
+		-I ${root}/../core/include \
+		-I ${root}/../encoding/include \
+		-I ${root}/../posix-wrapper/include \
+		-I ${root}/../print/include \
+		-o ${root}/build/2048-env-server \
+		${root}/src/env_server.cpp
+fi
+
+if [[ $OS != Windows_NT ]]; then
+	env_library=lib2048-env.so
+else
+	env_library=2048-env.dll
+fi
+
+clang++ \
+	-std=c++2b \
+	-nostdinc++ \
+	-Wall \
+	-Wextra \
+	-Wno-vla-cxx-extension \
+	-g \
+	-O3 \
+	-march=native \
+	-pthread \
+	-shared \
+	-fPIC \
+	-fvisibility=hidden \
+	-I ${root}/../core/include \
+	-I ${root}/../encoding/include \
+	-I ${root}/../posix-wrapper/include \
+	-I ${root}/../windows-wrapper/include \
+	-I ${root}/../print/include \
+	-o ${root}/build/${env_library} \
+	${root}/src/c_env.cpp
+
+clang++ \
+	-std=c++2b \
+	-nostdinc++ \
+	-Wall \
+	-Wextra \
+	-Wno-vla-cxx-extension \
+	-g \
+	-O3 \
+	-march=native \
+	-pthread \
+	-I ${root}/../core/include \
+	-I ${root}/../encoding/include \
+	-I ${root}/../posix-wrapper/include \
+	-I ${root}/../windows-wrapper/include \
+	-I ${root}/../print/include \
+	-o ${root}/build/2048-bench \
+	${root}/src/bench.cpp
\ No newline at end of file
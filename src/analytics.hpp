@@ -0,0 +1,186 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/memory.hpp>
+
+#include "./board.hpp"
+#include "./game.hpp"
+#include "./replay.hpp"
+#include "./thread.hpp"
+
+/*
+ distributions over replayed games, accumulated per thread and merged
+ with +=, value-initialize before use
+*/
+struct replay_stats_t {
+	/* games by game length, lengths / length_bucket, the last is open */
+	static constexpr nuint length_bucket = 16;
+	static constexpr nuint length_buckets = 4096;
+	/* boards by move number, move / move_bucket, the last is open */
+	static constexpr nuint move_bucket = 64;
+	static constexpr nuint move_buckets = 1024;
+	/* games by bit width of the score, 0 - zero score */
+	static constexpr nuint score_buckets = 48;
+
+	struct move_stats_t {
+		uint64 boards;
+		uint64 score;
+		uint64 empty;
+		uint64 max_exponent;
+	};
+
+	uint64 games;
+	/* records whose moves can't be replayed, not counted anywhere else */
+	uint64 invalid;
+	uint64 moves;
+	uint64 score;
+	uint64 scores[score_buckets];
+	uint64 max_exponents[16];
+	uint64 lengths[length_buckets];
+	move_stats_t per_move[move_buckets];
+
+	/* state after a move, game.moves is its number */
+	void add_move(const basic_game_t<board_t>& game) {
+		nuint bucket = (game.moves - 1) / move_bucket;
+		move_stats_t& s = per_move[bucket < move_buckets ? bucket : move_buckets - 1];
+		++s.boards;
+		s.score += game.score;
+		s.empty += game.board.empty_count();
+		s.max_exponent += game.board.max_exponent();
+	}
+
+	/* takes back add_move of the same state */
+	void remove_move(const basic_game_t<board_t>& game) {
+		nuint bucket = (game.moves - 1) / move_bucket;
+		move_stats_t& s = per_move[bucket < move_buckets ? bucket : move_buckets - 1];
+		--s.boards;
+		s.score -= game.score;
+		s.empty -= game.board.empty_count();
+		s.max_exponent -= game.board.max_exponent();
+	}
+
+	/* state at the end of a game */
+	void add_game(const basic_game_t<board_t>& game) {
+		++games;
+		moves += game.moves;
+		score += game.score;
+
+		nuint width = game.score == 0 ? 0 : 64 - __builtin_clzll(game.score);
+		++scores[width < score_buckets ? width : score_buckets - 1];
+
+		++max_exponents[game.board.max_exponent()];
+
+		nuint length = game.moves / length_bucket;
+		++lengths[length < length_buckets ? length : length_buckets - 1];
+	}
+
+	replay_stats_t& operator += (const replay_stats_t& other) {
+		games += other.games;
+		invalid += other.invalid;
+		moves += other.moves;
+		score += other.score;
+		for (nuint i = 0; i < score_buckets; ++i) scores[i] += other.scores[i];
+		for (nuint i = 0; i < 16; ++i) max_exponents[i] += other.max_exponents[i];
+		for (nuint i = 0; i < length_buckets; ++i) lengths[i] += other.lengths[i];
+		for (nuint i = 0; i < move_buckets; ++i) {
+			per_move[i].boards += other.per_move[i].boards;
+			per_move[i].score += other.per_move[i].score;
+			per_move[i].empty += other.per_move[i].empty;
+			per_move[i].max_exponent += other.per_move[i].max_exponent;
+		}
+		return *this;
+	}
+
+	/* games whose largest tile is at least 2^exponent */
+	uint64 games_reaching(uint8 exponent) const {
+		uint64 count = 0;
+		for (nuint e = exponent; e < 16; ++e) count += max_exponents[e];
+		return count;
+	}
+
+	/* upper bound of the length bucket with `percent`% of games at or below */
+	nuint length_percentile(nuint percent) const {
+		uint64 needed = (games * percent + 99) / 100;
+		uint64 count = 0;
+		for (nuint i = 0; i < length_buckets; ++i) {
+			count += lengths[i];
+			if (count >= needed && count != 0) return (i + 1) * length_bucket;
+		}
+		return length_buckets * length_bucket;
+	}
+};
+
+/*
+ replays every record of the archive through the engine on `threads`
+ threads. records are found by one pass over their headers, then
+ threads take them in chunks. records that fail to replay are counted
+ in `total.invalid` and skipped. returns the number of records,
+ `end` is the offset where reading stopped (archive size if all valid)
+*/
+inline nuint analyze_replays(
+	replay_archive_t archive, nuint threads,
+	replay_stats_t& total, nuint& end
+) {
+	static constexpr nuint chunk = 64;
+
+	nuint count = 0;
+	replay_t replay;
+	end = replay_archive_t::begin;
+	while (archive.try_next(end, replay)) ++count;
+
+	posix::memory<uint64> offsets = posix::allocate<uint64>(count);
+	nuint offset = replay_archive_t::begin;
+	for (nuint i = 0; i < count; ++i) {
+		offsets.iterator()[i] = offset;
+		archive.try_next(offset, replay);
+	}
+
+	if (threads == 0) threads = 1;
+	posix::memory<replay_stats_t> thread_stats
+		= posix::allocate<replay_stats_t>(threads);
+	for (nuint i = 0; i < threads; ++i) {
+		thread_stats.iterator()[i] = replay_stats_t{};
+	}
+
+	nuint next = 0;
+
+	run_on_threads(threads, [&](nuint thread) {
+		replay_stats_t& stats = thread_stats.iterator()[thread];
+
+		while (true) {
+			nuint first = __atomic_fetch_add(&next, chunk, __ATOMIC_RELAXED);
+			if (first >= count) break;
+			nuint last = first + chunk < count ? first + chunk : count;
+
+			for (nuint i = first; i < last; ++i) {
+				nuint record_offset = offsets.iterator()[i];
+				replay_t r;
+				archive.try_next(record_offset, r);
+
+				basic_game_t<board_t> game { r.header->seed };
+				nuint counted = 0;
+				bool valid = r.replay(game, r.moves(), [&](auto& g, direction_t) {
+					stats.add_move(g);
+					++counted;
+				});
+
+				if (valid) {
+					stats.add_game(game);
+					continue;
+				}
+
+				// rare, moves counted before the invalid one are taken back
+				++stats.invalid;
+				basic_game_t<board_t> again { r.header->seed };
+				r.replay(again, counted, [&](auto& g, direction_t) {
+					stats.remove_move(g);
+				});
+			}
+		}
+	});
+
+	for (nuint i = 0; i < threads; ++i) {
+		total += thread_stats.iterator()[i];
+	}
+	return count;
+}
\ No newline at end of file
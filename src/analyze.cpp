@@ -0,0 +1,126 @@
+#include "./posix_handlers.hpp"
+#include "./analytics.hpp"
+#include "./replay.hpp"
+#include "./table_file.hpp"
+#include "./thread.hpp"
+#include "./tool.hpp"
+
+#include <print/print.hpp>
+
+#include <posix/memory.hpp>
+#include <posix/time.hpp>
+
+static int usage() {
+	print::err(
+		"usage: 2048-analyze [--threads <count>] [--per-move]\n"
+		"                    <replay archive>...\n"
+	);
+	return 1;
+}
+
+/* part / whole as "<integer>.<2 digits>%" */
+int main(int argc, char** argv) {
+	uint64 threads = hardware_threads();
+	bool per_move = false;
+	nuint archive_count = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+
+		if (equals(arg, "--threads")) {
+			if (
+				++i == argc ||
+				!try_parse_number(argv[i], threads) || threads == 0
+			) return usage();
+		}
+		else if (equals(arg, "--per-move")) {
+			per_move = true;
+		}
+		else if (arg[0] == '-') {
+			return usage();
+		}
+		else {
+			++archive_count;
+		}
+	}
+
+	if (archive_count == 0) return usage();
+
+	posix::memory<replay_stats_t> total_storage
+		= posix::allocate<replay_stats_t>(1);
+	replay_stats_t& total = *total_storage.iterator();
+	total = replay_stats_t{};
+
+	posix::ticks_t begin = posix::get_ticks();
+
+	for (int i = 1; i < argc; ++i) {
+		if (equals(argv[i], "--threads")) { ++i; continue; }
+		if (argv[i][0] == '-') continue;
+
+		table_file_t file { argv[i] };
+		replay_archive_t archive { file.data, file.size };
+		if (file.data == nullptr || !archive.valid()) {
+			print::err(argv[i], ": not a replay archive\n");
+			return 1;
+		}
+
+		nuint end;
+		analyze_replays(archive, threads, total, end);
+		if (end != file.size) {
+			print::err(argv[i], ": invalid record at ", end, ", rest is skipped\n");
+		}
+	}
+
+	posix::ticks_t ticks = posix::get_ticks() - begin;
+	double seconds = seconds_of(ticks);
+
+	if (total.invalid != 0) {
+		print::err(total.invalid, " records can't be replayed, skipped\n");
+	}
+
+	if (total.games == 0) {
+		print::out("games: 0\n");
+		return 0;
+	}
+
+	print::out("games: ", total.games, "\n");
+	print::out("moves: ", total.moves, "\n");
+	print::out("average score: ", total.score / total.games, "\n");
+	print::out("moves/sec: ", uint64(double(total.moves) / seconds), "\n");
+
+	print::out("game length:");
+	for (nuint percent : { 10, 50, 90, 99 }) {
+		print::out(" p", percent, " <= ", total.length_percentile(percent));
+	}
+	print::out("\n");
+
+	print::out("max tile reached:\n");
+	for (uint8 e = 1; e < 16; ++e) {
+		uint64 reaching = total.games_reaching(e);
+		if (reaching == 0) break;
+		print::out("\t", uint32(1) << e, ": ");
+		print_fixed(reaching * 10000 / total.games, 2);
+		print::out("%\n");
+	}
+
+	print::out("score:\n");
+	for (nuint i = 0; i < replay_stats_t::score_buckets; ++i) {
+		if (total.scores[i] == 0) continue;
+		uint64 low = i == 0 ? 0 : uint64(1) << (i - 1);
+		print::out("\t", low, "..", (uint64(1) << i) - 1, ": ", total.scores[i], "\n");
+	}
+
+	if (per_move) {
+		print::out("moves, boards, average score, empty cells, max tile exponent:\n");
+		for (nuint i = 0; i < replay_stats_t::move_buckets; ++i) {
+			const replay_stats_t::move_stats_t& s = total.per_move[i];
+			if (s.boards == 0) continue;
+			print::out(
+				"\t", i * replay_stats_t::move_bucket + 1, "..",
+				(i + 1) * replay_stats_t::move_bucket, ", ",
+				s.boards, ", ", s.score / s.boards, ", ",
+				s.empty / s.boards, ", ", s.max_exponent / s.boards, "\n"
+			);
+		}
+	}
+}
\ No newline at end of file
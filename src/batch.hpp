@@ -0,0 +1,204 @@
+#pragma once
+
+#include <integer.hpp>
+
+#include "./direction.hpp"
+#include "./game.hpp"
+#include "./random.hpp"
+#include "./thread.hpp"
+
+/* accumulated results of many games, value-initialize before use */
+struct batch_result_t {
+	uint64 games;
+	uint64 moves;
+	uint64 score;
+	/*
+	 number of games by the exponent of their largest tile,
+	 boards larger than 4x4 have exponents past 15
+	*/
+	static constexpr nuint exponents = 64;
+	uint64 max_exponents[exponents];
+
+	template<typename Board>
+	void add(const basic_game_t<Board>& game) {
+		++games;
+		moves += game.moves;
+		score += game.score;
+		++max_exponents[game.board.max_exponent()];
+	}
+
+	batch_result_t& operator += (const batch_result_t& other) {
+		games += other.games;
+		moves += other.moves;
+		score += other.score;
+		for (nuint e = 0; e < exponents; ++e) {
+			max_exponents[e] += other.max_exponents[e];
+		}
+		return *this;
+	}
+
+	uint8 max_exponent() const {
+		for (nuint e = exponents; e > 0; --e) {
+			if (max_exponents[e - 1] != 0) return e - 1;
+		}
+		return 0;
+	}
+};
+
+/* same as the game_index-th splitmix64_t { seed }.next() */
+inline uint64 game_seed(uint64 seed, uint64 game_index) {
+	return splitmix64_t { seed + game_index * 0x9E3779B97F4A7C15ULL }.next();
+}
+
+/* sees every game of a thread, e.g. to record it, this one does nothing */
+struct null_game_observer_t {
+	void on_begin(const auto&) {}
+	void on_move(const auto&, direction_t) {}
+	void on_end(const auto&) {}
+};
+
+template<typename Board>
+inline void play_game(
+	basic_game_t<Board>& game, auto& policy, auto& observer
+) {
+	observer.on_begin(game);
+	while (true) {
+		direction_t dir = policy(game.board, game.random);
+		if (dir == invalid) break;
+		game.try_move(dir);
+		observer.on_move(game, dir);
+	}
+	observer.on_end(game);
+}
+
+template<typename Board>
+inline void play_game(basic_game_t<Board>& game, auto& policy) {
+	null_game_observer_t observer{};
+	play_game(game, policy, observer);
+}
+
+/*
+ range of game indices owned by a worker, begin in the lower 32 bits,
+ end in the upper. the owner takes games from the front and idle workers
+ steal the back half, both with a single CAS
+*/
+struct alignas(64) games_range_t {
+	uint64 value;
+
+	static constexpr uint64 pack(uint32 begin, uint32 end) {
+		return uint64(begin) | uint64(end) << 32;
+	}
+
+	void reset(uint32 begin, uint32 end) {
+		__atomic_store_n(&value, pack(begin, end), __ATOMIC_RELEASE);
+	}
+
+	bool try_take_front(uint32& index) {
+		uint64 current = __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+		while (true) {
+			uint32 begin = current, end = current >> 32;
+			if (begin >= end) return false;
+
+			if (__atomic_compare_exchange_n(
+				&value, &current, pack(begin + 1, end),
+				true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+			)) {
+				index = begin;
+				return true;
+			}
+		}
+	}
+
+	bool try_steal_half(uint32& stolen_begin, uint32& stolen_end) {
+		uint64 current = __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+		while (true) {
+			uint32 begin = current, end = current >> 32;
+			if (begin >= end) return false;
+
+			uint32 middle = begin + (end - begin) / 2;
+
+			if (__atomic_compare_exchange_n(
+				&value, &current, pack(begin, middle),
+				true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+			)) {
+				stolen_begin = middle;
+				stolen_end = end;
+				return true;
+			}
+		}
+	}
+};
+
+/*
+ plays `games` independent games on `threads` threads with work-stealing,
+ every game gets its own copy of the policy and its own random state, so
+ for policies that depend only on them the results don't depend on the
+ number of threads. searches that don't (a time budget, several search
+ threads, expectimax's table kept by the thread between games) can give
+ other results. every thread gets its own observer from make_observer()
+*/
+template<typename Board = board_t>
+inline batch_result_t play_games(
+	uint32 games, uint64 seed, nuint threads, auto policy,
+	auto make_observer
+) {
+	if (threads == 0) threads = 1;
+
+	struct alignas(64) thread_result_t {
+		batch_result_t result;
+	};
+
+	games_range_t ranges[threads];
+	thread_result_t results[threads];
+
+	for (nuint i = 0; i < threads; ++i) {
+		ranges[i].value = games_range_t::pack(
+			uint64(games) * i / threads,
+			uint64(games) * (i + 1) / threads
+		);
+		results[i].result = batch_result_t{};
+	}
+
+	run_on_threads(threads, [&](nuint thread) {
+		batch_result_t& result = results[thread].result;
+		games_range_t& own = ranges[thread];
+		auto observer = make_observer();
+
+		while (true) {
+			uint32 index;
+			if (own.try_take_front(index)) {
+				auto game_policy = policy;
+				basic_game_t<Board> game { game_seed(seed, index) };
+				play_game(game, game_policy, observer);
+				result.add(game);
+				continue;
+			}
+
+			bool stolen = false;
+			for (nuint i = 1; i < threads && !stolen; ++i) {
+				uint32 begin, end;
+				if (ranges[(thread + i) % threads].try_steal_half(begin, end)) {
+					own.reset(begin, end);
+					stolen = true;
+				}
+			}
+
+			if (!stolen) break;
+		}
+	});
+
+	batch_result_t total{};
+	for (nuint i = 0; i < threads; ++i) {
+		total += results[i].result;
+	}
+	return total;
+}
+
+template<typename Board = board_t>
+inline batch_result_t play_games(
+	uint32 games, uint64 seed, nuint threads, auto policy
+) {
+	return play_games<Board>(
+		games, seed, threads, policy, [] { return null_game_observer_t{}; }
+	);
+}
\ No newline at end of file
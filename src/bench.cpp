@@ -0,0 +1,528 @@
+#include "./posix_handlers.hpp"
+#include "./batch.hpp"
+#include "./game.hpp"
+#include "./move_batch.hpp"
+#include "./perf_counters.hpp"
+#include "./policy.hpp"
+#include "./replay.hpp"
+#include "./table.hpp"
+#include "./table_file.hpp"
+#include "./tool.hpp"
+
+#include <print/print.hpp>
+
+#include <posix/memory.hpp>
+#include <posix/time.hpp>
+
+static int usage() {
+	print::err(
+		"usage: 2048-bench [--boards <count>] [--runs <count>]\n"
+		"                  [--games <count>] [--seed <seed>]\n"
+		"                  [<replay archive>...]\n"
+		"       2048-bench --self-check [--boards <count>] [--seed <seed>]\n"
+	);
+	return 1;
+}
+
+/* keeps the compiler from dropping the computation of `value` */
+static inline void keep(uint64 value) {
+	asm volatile("" : : "r"(value) : "memory");
+}
+
+/* rounded, for print_fixed(..., 3) */
+static uint64 thousandths(double value) {
+	return uint64(value * 1000.0 + 0.5);
+}
+
+/*
+ uniform sample (reservoir) of boards seen in play, so the benchmarks
+ run on the tiles and empty cells that games actually have
+*/
+struct board_sample_t {
+	posix::memory<board_t> boards;
+	nuint capacity;
+	uint64 seen = 0;
+	random_t random;
+
+	board_sample_t(nuint capacity, uint64 seed) :
+		boards { posix::allocate<board_t>(capacity) },
+		capacity { capacity },
+		random { seed }
+	{}
+
+	void add(board_t board) {
+		if (seen < capacity) {
+			boards.iterator()[seen] = board;
+		}
+		else {
+			uint64 i = random.next(seen + 1);
+			if (i < capacity) boards.iterator()[i] = board;
+		}
+		++seen;
+	}
+
+	nuint size() const { return seen < capacity ? seen : capacity; }
+
+	board_t operator [] (nuint i) const { return boards.iterator()[i]; }
+};
+
+struct bench_t {
+	nuint runs;
+	perf_counters_t counters{};
+	bool first = true;
+
+	/*
+	 one untimed run, then `runs` timed ones of `ops` operations each,
+	 prints the JSON object of the benchmark
+	*/
+	void measure(const char* name, nuint ops, auto&& run) {
+		run();
+
+		double sum = 0.0, sum_squares = 0.0, min = 0.0;
+		uint64 counts[perf_counters_t::count]{};
+
+		for (nuint r = 0; r < runs; ++r) {
+			counters.start();
+			posix::ticks_t begin = posix::get_ticks();
+			run();
+			posix::ticks_t ticks = posix::get_ticks() - begin;
+			counters.stop(counts);
+
+			double ns = double(ticks) * 1e9 / double(posix::ticks_per_second);
+			double ns_per_op = ns / double(ops);
+			sum += ns_per_op;
+			sum_squares += ns_per_op * ns_per_op;
+			if (r == 0 || ns_per_op < min) min = ns_per_op;
+		}
+
+		double mean = sum / double(runs);
+		double variance = runs < 2 ? 0.0 :
+			(sum_squares - sum * mean) / double(runs - 1);
+		if (variance < 0.0) variance = 0.0;
+
+		print::out(first ? "\n" : ",\n");
+		first = false;
+
+		print::out("\t\t{ \"name\": \"", name, "\", \"ops\": ", ops);
+		print::out(", \"ns_per_op\": ");
+		print_fixed(thousandths(mean), 3);
+		print::out(", \"min_ns_per_op\": ");
+		print_fixed(thousandths(min), 3);
+		print::out(", \"variance_ns2\": ");
+		print_fixed(thousandths(variance), 3);
+		print::out(", \"ops_per_sec\": ");
+		print::out(mean > 0.0 ? uint64(1e9 / mean) : uint64(0));
+
+		print::out(", \"counters_per_op\": ");
+		if (!counters.any_available()) {
+			print::out("null");
+		}
+		else {
+			print::out("{");
+			bool first_counter = true;
+			for (nuint i = 0; i < perf_counters_t::count; ++i) {
+				if (!counters.available(i)) continue;
+				print::out(first_counter ? " \"" : ", \"");
+				print::out(perf_counters_t::names[i], "\": ");
+				double per_op = double(counts[i]) / double(ops * runs);
+				print_fixed(thousandths(per_op), 3);
+				first_counter = false;
+			}
+			print::out(" }");
+		}
+		print::out(" }");
+	}
+};
+
+/*
+ boards of random tiles up to a random exponent (1..15) per board,
+ with about half of the cells empty, so moves both merge and slide
+*/
+static board_t random_board(random_t& random) {
+	nuint max_exponent = 1 + random.next(15);
+	board_t board{};
+	for (nuint cell = 0; cell < 16; ++cell) {
+		if (random.next(2) == 0) continue;
+		board.exponent(cell % 4, cell / 4, uint8(random.next(max_exponent + 1)));
+	}
+	return board;
+}
+
+/*
+ move_boards (the AVX2 kernel, when it's compiled in) against
+ move_boards_scalar, for every board in each direction and in mixed ones.
+ prints the first mismatch, returns the number of them
+*/
+static nuint check_move_boards(uint64 seed, nuint count) {
+	random_t random { seed };
+
+	posix::memory<board_t> boards = posix::allocate<board_t>(count);
+	posix::memory<uint8> actions = posix::allocate<uint8>(count);
+	for (nuint i = 0; i < count; ++i) {
+		boards.iterator()[i] = random_board(random);
+	}
+
+	posix::memory<board_t> results[2] {
+		posix::allocate<board_t>(count), posix::allocate<board_t>(count)
+	};
+	posix::memory<uint32> rewards[2] {
+		posix::allocate<uint32>(count), posix::allocate<uint32>(count)
+	};
+	posix::memory<uint8> moved[2] {
+		posix::allocate<uint8>(count), posix::allocate<uint8>(count)
+	};
+
+	nuint mismatches = 0;
+
+	// 4 - a random direction for every board
+	for (nuint pass = 0; pass <= 4; ++pass) {
+		for (nuint i = 0; i < count; ++i) {
+			actions.iterator()[i] = pass < 4 ? pass : random.next(4);
+		}
+
+		move_boards(
+			boards.iterator(), actions.iterator(), count,
+			results[0].iterator(), rewards[0].iterator(), moved[0].iterator()
+		);
+		move_boards_scalar(
+			boards.iterator(), actions.iterator(), count,
+			results[1].iterator(), rewards[1].iterator(), moved[1].iterator()
+		);
+
+		for (nuint i = 0; i < count; ++i) {
+			if (
+				results[0].iterator()[i] == results[1].iterator()[i] &&
+				rewards[0].iterator()[i] == rewards[1].iterator()[i] &&
+				moved[0].iterator()[i] == moved[1].iterator()[i]
+			) continue;
+
+			if (mismatches++ == 0) {
+				print::err(
+					"move_boards: board ", boards.iterator()[i].cells,
+					", direction ", nuint(actions.iterator()[i]),
+					": board ", results[0].iterator()[i].cells,
+					", reward ", rewards[0].iterator()[i],
+					", moved ", nuint(moved[0].iterator()[i]),
+					", scalar: board ", results[1].iterator()[i].cells,
+					", reward ", rewards[1].iterator()[i],
+					", moved ", nuint(moved[1].iterator()[i]), "\n"
+				);
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+/* move of every line of the board by move_line, cell by cell */
+template<direction_t Dir>
+static basic_move_result_t<board_t> reference_move(
+	board_t board, uint32& distances
+) {
+	board_t result{};
+	uint32 score = 0;
+	distances = 0;
+
+	for (nuint line = 0; line < 4; ++line) {
+		auto x = [&](nuint i) { return is_vertical<Dir> ? line : i; };
+		auto y = [&](nuint i) { return is_vertical<Dir> ? i : line; };
+
+		uint64 cells = 0;
+		for (nuint i = 0; i < 4; ++i) {
+			cells |= uint64(board.exponent(x(i), y(i))) << (4 * i);
+		}
+
+		line_move_t move = move_line<4>(cells, towards_end<Dir>);
+		score += move.score;
+
+		for (nuint i = 0; i < 4; ++i) {
+			result.exponent(x(i), y(i), (move.line >> (4 * i)) & 0xF);
+			distances |= ((move.distances >> (4 * i)) & 0xF)
+				<< (2 * (y(i) * 4 + x(i)));
+		}
+	}
+
+	return { result, score };
+}
+
+/*
+ moves, scores, legal moves and animation distances from move_tables
+ against reference_move. prints the first mismatch, returns 1 if any
+*/
+template<direction_t Dir>
+static nuint check_move_tables(board_t board, nuint mismatches) {
+	uint32 distances;
+	move_result_t expected = reference_move<Dir>(board, distances);
+	move_result_t move = move_with_score<Dir>(board);
+
+	if (
+		move.board == expected.board &&
+		move.score == expected.score &&
+		move_board(board, Dir) == expected.board &&
+		merge_score(board, Dir) == expected.score &&
+		bool(legal_moves(board) & (1 << Dir.value))
+			== (expected.board != board) &&
+		movement_table_of<Dir>(board).distances == distances
+	) return 0;
+
+	if (mismatches == 0) {
+		print::err(
+			"move_tables: board ", board.cells,
+			", direction ", nuint(Dir.value),
+			": board ", move.board.cells, ", score ", move.score,
+			", distances ", movement_table_of<Dir>(board).distances,
+			", move_line: board ", expected.board.cells,
+			", score ", expected.score, ", distances ", distances, "\n"
+		);
+	}
+	return 1;
+}
+
+/* every direction of random boards and of every single row and column */
+static nuint check_move_tables(uint64 seed, nuint count) {
+	random_t random { seed };
+	nuint mismatches = 0;
+
+	auto check = [&](board_t board) {
+		mismatches += check_move_tables<up>(board, mismatches);
+		mismatches += check_move_tables<down>(board, mismatches);
+		mismatches += check_move_tables<left>(board, mismatches);
+		mismatches += check_move_tables<right>(board, mismatches);
+	};
+
+	for (uint64 line = 0; line < 65536; ++line) {
+		check(board_t { line << 32 });
+		check(board_t { line }.transposed());
+	}
+	for (nuint i = 0; i < count; ++i) {
+		check(random_board(random));
+	}
+
+	return mismatches;
+}
+
+template<direction_t Dir>
+static void bench_direction(
+	bench_t& bench, const board_sample_t& sample,
+	const char* move_name, const char* try_move_name
+) {
+	nuint count = sample.size();
+
+	bench.measure(move_name, count, [&] {
+		uint64 sink = 0;
+		for (nuint i = 0; i < count; ++i) {
+			move_result_t move = move_with_score<Dir>(sample[i]);
+			sink += move.board.cells ^ move.score;
+		}
+		keep(sink);
+	});
+
+	basic_game_t<board_t> game { 0 };
+	bench.measure(try_move_name, count, [&] {
+		uint64 sink = 0;
+		for (nuint i = 0; i < count; ++i) {
+			game.board = sample[i];
+			sink += game.try_move<Dir>();
+			sink ^= game.board.cells;
+		}
+		keep(sink);
+	});
+}
+
+int main(int argc, char** argv) {
+	uint64 board_count = 65536;
+	uint64 runs = 20;
+	uint64 games = 256;
+	uint64 seed = 0;
+	bool self_check = false;
+	nuint archive_count = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+
+		auto number = [&](uint64& value) {
+			return ++i < argc && try_parse_number(argv[i], value) && value != 0;
+		};
+
+		if (equals(arg, "--boards")) {
+			if (!number(board_count)) return usage();
+		}
+		else if (equals(arg, "--runs")) {
+			if (!number(runs)) return usage();
+		}
+		else if (equals(arg, "--games")) {
+			if (!number(games)) return usage();
+		}
+		else if (equals(arg, "--seed")) {
+			if (++i == argc || !try_parse_number(argv[i], seed)) return usage();
+		}
+		else if (equals(arg, "--self-check")) {
+			self_check = true;
+		}
+		else if (arg[0] == '-') {
+			return usage();
+		}
+		else {
+			++archive_count;
+		}
+	}
+
+	if (self_check) {
+		if (archive_count > 0) return usage();
+
+		nuint table_mismatches = check_move_tables(seed, board_count);
+		print::out("move_tables: ", table_mismatches, " mismatches\n");
+		nuint mismatches = check_move_boards(seed, board_count);
+		print::out("move_boards: ", mismatches, " mismatches\n");
+		return table_mismatches == 0 && mismatches == 0 ? 0 : 1;
+	}
+
+	board_sample_t sample { board_count, seed };
+
+	if (archive_count > 0) {
+		for (int i = 1; i < argc; ++i) {
+			if (argv[i][0] == '-') { ++i; continue; }
+
+			table_file_t file { argv[i] };
+			replay_archive_t archive { file.data, file.size };
+			if (file.data == nullptr || !archive.valid()) {
+				print::err(argv[i], ": not a replay archive\n");
+				return 1;
+			}
+
+			nuint offset = replay_archive_t::begin;
+			replay_t replay;
+			nuint invalid = 0;
+			while (archive.try_next(offset, replay)) {
+				basic_game_t<board_t> game { replay.header->seed };
+				sample.add(game.board);
+				bool valid = replay.replay(
+					game, replay.moves(), [&](auto& g, direction_t) {
+						sample.add(g.board);
+					}
+				);
+				if (!valid) ++invalid;
+			}
+			if (invalid != 0) {
+				print::err(
+					argv[i], ": ", invalid, " invalid records, ",
+					"sampled up to their invalid moves\n"
+				);
+			}
+		}
+	}
+	else {
+		// greedy games get further than random ones, closer to real play
+		greedy_policy_t policy{};
+		for (uint64 g = 0; sample.seen < 4 * board_count; ++g) {
+			basic_game_t<board_t> game { game_seed(seed, g) };
+			sample.add(game.board);
+			while (game.try_move(policy(game.board, game.random))) {
+				sample.add(game.board);
+			}
+		}
+	}
+
+	if (sample.size() == 0) {
+		print::err("no boards to sample\n");
+		return 1;
+	}
+
+	nuint count = sample.size();
+	bench_t bench { .runs = runs };
+
+	print::out("{\n");
+	print::out("\t\"boards\": ", count, ",\n");
+	print::out(
+		"\t\"boards_from\": \"",
+		archive_count > 0 ? "replays" : "greedy games", "\",\n"
+	);
+	print::out("\t\"runs\": ", runs, ",\n");
+	print::out("\t\"benchmarks\": [");
+
+	bench_direction<up>(bench, sample, "move_with_score/up", "try_move/up");
+	bench_direction<down>(bench, sample, "move_with_score/down", "try_move/down");
+	bench_direction<left>(bench, sample, "move_with_score/left", "try_move/left");
+	bench_direction<right>(bench, sample, "move_with_score/right", "try_move/right");
+
+	random_t random { seed };
+	bench.measure("try_put_random_value", count, [&] {
+		uint64 sink = 0;
+		for (nuint i = 0; i < count; ++i) {
+			board_t board = sample[i];
+			sink += board.try_put_random_value(random);
+			sink ^= board.cells;
+		}
+		keep(sink);
+	});
+
+	/* every board in its own direction, as vector_env_t steps them */
+	posix::memory<uint8> actions = posix::allocate<uint8>(count);
+	posix::memory<board_t> results = posix::allocate<board_t>(count);
+	posix::memory<uint32> rewards = posix::allocate<uint32>(count);
+	posix::memory<uint8> moved = posix::allocate<uint8>(count);
+	for (nuint i = 0; i < count; ++i) {
+		actions.iterator()[i] = random.next(4);
+	}
+	posix::memory<board_t> boards = posix::allocate<board_t>(count);
+	for (nuint i = 0; i < count; ++i) boards.iterator()[i] = sample[i];
+
+	bench.measure("move_boards_scalar", count, [&] {
+		move_boards_scalar(
+			boards.iterator(), actions.iterator(), count,
+			results.iterator(), rewards.iterator(), moved.iterator()
+		);
+		asm volatile("" : : "r"(results.iterator()) : "memory");
+	});
+
+	bench.measure("move_boards", count, [&] {
+		move_boards(
+			boards.iterator(), actions.iterator(), count,
+			results.iterator(), rewards.iterator(), moved.iterator()
+		);
+		asm volatile("" : : "r"(results.iterator()) : "memory");
+	});
+
+	bench.measure("is_terminal", count, [&] {
+		uint64 sink = 0;
+		for (nuint i = 0; i < count; ++i) {
+			sink += is_terminal(sample[i]);
+		}
+		keep(sink);
+	});
+
+	posix::memory<board_t> board_copies = posix::allocate<board_t>(count);
+	bench.measure("board_copy", count, [&] {
+		for (nuint i = 0; i < count; ++i) {
+			board_copies.iterator()[i] = sample[i];
+			asm volatile("" : : "r"(board_copies.iterator() + i) : "memory");
+		}
+	});
+
+	/* the 16 x uint32 table the renderer uses, for comparison */
+	posix::memory<table_t> tables = posix::allocate<table_t>(count);
+	for (nuint i = 0; i < count; ++i) {
+		tables.iterator()[i] = table_t::from_board(sample[i]);
+	}
+	table_t table_copy{};
+	bench.measure("table_copy", count, [&] {
+		for (nuint i = 0; i < count; ++i) {
+			table_copy = tables.iterator()[i];
+			asm volatile("" : : "r"(&table_copy) : "memory");
+		}
+	});
+
+	uint64 game_index = 0;
+	bench.measure("random_game", games, [&] {
+		random_policy_t policy{};
+		uint64 sink = 0;
+		for (nuint i = 0; i < games; ++i) {
+			basic_game_t<board_t> game { game_seed(seed, game_index++) };
+			play_game(game, policy);
+			sink += game.score;
+		}
+		keep(sink);
+	});
+
+	print::out("\n\t]\n}\n");
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <integer.hpp>
+
+#if __BMI2__
+#include <immintrin.h>
+#endif
+
+static constexpr nuint table_rows = 4;
+
+/*
+ packed board, every cell is a 4-bit exponent of the tile value
+ (0 - empty, e - 2^e), so the largest storable tile is 2^15
+
+ cell [y][x] lives at bits 4 * (y * 4 + x), so row y is the 16 bits
+ at 16 * y with x = 0 in the lowest nibble:
+ bits  0..15 - [0][0] [0][1] [0][2] [0][3]
+ bits 16..31 - [1][0] [1][1] [1][2] [1][3]
+ ...
+*/
+struct board_t {
+	uint64 cells = 0;
+
+	constexpr board_t() {}
+	constexpr explicit board_t(uint64 cells) : cells { cells } {}
+
+	constexpr bool operator == (board_t other) const {
+		return cells == other.cells;
+	}
+
+	constexpr uint8 exponent(nuint x, nuint y) const {
+		return (cells >> (4 * (y * table_rows + x))) & 0xF;
+	}
+
+	constexpr void exponent(nuint x, nuint y, uint8 e) {
+		nuint shift = 4 * (y * table_rows + x);
+		cells = (cells & ~(uint64(0xF) << shift)) | (uint64(e & 0xF) << shift);
+	}
+
+	constexpr uint32 value(nuint x, nuint y) const {
+		uint8 e = exponent(x, y);
+		return e == 0 ? 0 : uint32(1) << e;
+	}
+
+	constexpr uint16 row(nuint y) const {
+		return (cells >> (16 * y)) & 0xFFFF;
+	}
+
+	/* [y][x] -> [x][y], columns become rows */
+	constexpr board_t transposed() const {
+		uint64 a1 = cells & 0xF0F00F0FF0F00F0FULL;
+		uint64 a2 = cells & 0x0000F0F00000F0F0ULL;
+		uint64 a3 = cells & 0x0F0F00000F0F0000ULL;
+		uint64 a = a1 | (a2 << 12) | (a3 >> 12);
+		uint64 b1 = a & 0xFF00FF0000FF00FFULL;
+		uint64 b2 = a & 0x00FF00FF00000000ULL;
+		uint64 b3 = a & 0x00000000FF00FF00ULL;
+		return board_t { b1 | (b2 >> 24) | (b3 << 24) };
+	}
+
+	/* bit 4 * i is set for every empty cell i */
+	constexpr uint64 empty_mask() const {
+		uint64 x = cells | (cells >> 1);
+		x |= x >> 2;
+		return ~x & 0x1111111111111111ULL;
+	}
+
+	constexpr nuint empty_count() const {
+		return __builtin_popcountll(empty_mask());
+	}
+
+	constexpr uint8 max_exponent() const {
+		uint8 max = 0;
+		for (nuint i = 0; i < table_rows * table_rows; ++i) {
+			uint8 e = (cells >> (4 * i)) & 0xF;
+			max = e > max ? e : max;
+		}
+		return max;
+	}
+
+	inline bool try_put_random_value(auto& random);
+};
+
+static_assert(sizeof(board_t) == sizeof(uint64));
+
+constexpr uint8 value_to_exponent(uint32 value) {
+	return value == 0 ? 0 : __builtin_ctz(value);
+}
+
+/* n-th (from 0) lowest set bit of the mask */
+inline uint64 nth_set_bit(uint64 mask, nuint n) {
+#if __BMI2__
+	return _pdep_u64(uint64(1) << n, mask);
+#else
+	for (; n > 0; --n) mask &= mask - 1;
+	return mask & -mask;
+#endif
+}
+
+bool board_t::try_put_random_value(auto& random) {
+	uint64 empty = empty_mask();
+	nuint empty_count = __builtin_popcountll(empty);
+
+	if (empty_count == 0) return false;
+
+	// one draw for both the cell and the value (2 or 4)
+	nuint choice = random.next(empty_count * 2);
+	uint64 cell_bit = nth_set_bit(empty, choice >> 1);
+	cells |= uint64((choice & 1) + 1) << __builtin_ctzll(cell_bit);
+
+	return true;
+}
\ No newline at end of file
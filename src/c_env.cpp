@@ -0,0 +1,67 @@
+#include "./posix_handlers.hpp"
+#define ENV2048_BUILD 1
+#include "./c_env.h"
+#include "./env.hpp"
+
+struct env2048 {
+	vector_env_t env;
+};
+
+static void observe(env2048& e, env2048_observation observation) {
+	nuint count = e.env.count;
+
+	if (observation.boards != nullptr) {
+		e.env.boards(0, count, (uint64*) observation.boards);
+	}
+
+	if (observation.exponents != nullptr) {
+		for (nuint i = 0; i < count; ++i) {
+			uint64 cells = e.env.game(i).board.cells;
+			for (nuint cell = 0; cell < 16; ++cell) {
+				observation.exponents[cell * count + i]
+					= (cells >> (4 * cell)) & 0xF;
+			}
+		}
+	}
+}
+
+extern "C" {
+
+env2048* env2048_create(uint32_t n_envs, uint64_t seed) {
+	if (n_envs == 0) return nullptr;
+	return new env2048 { vector_env_t { n_envs, seed } };
+}
+
+void env2048_destroy(env2048* env) {
+	delete env;
+}
+
+uint32_t env2048_count(const env2048* env) {
+	return env->env.count;
+}
+
+void env2048_reset(env2048* env, env2048_observation observation) {
+	env->env.reset();
+	observe(*env, observation);
+}
+
+void env2048_step(
+	env2048* env, const uint8_t* actions,
+	env2048_observation observation,
+	uint32_t* rewards, uint8_t* terminals
+) {
+	env->env.step(
+		0, env->env.count, actions, (uint32*) rewards, terminals
+	);
+	observe(*env, observation);
+}
+
+void env2048_legal_masks(const env2048* env, uint8_t* masks) {
+	env->env.legal_masks(0, env->env.count, masks);
+}
+
+void env2048_scores(const env2048* env, uint64_t* scores) {
+	env->env.scores(0, env->env.count, (uint64*) scores);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+ C interface of lib2048-env: `n_envs` games stepped together.
+ every buffer is owned by the caller and holds one element per env
+ (exponent planes hold 16 * n_envs), the library doesn't allocate
+ after env2048_create.
+
+ an env whose game is over starts a new one in the same step: its
+ terminal is 1 and the observation is of the new game
+*/
+
+#include <stdint.h>
+
+#if _WIN32 && ENV2048_BUILD
+#define ENV2048_API __declspec(dllexport)
+#elif _WIN32
+#define ENV2048_API __declspec(dllimport)
+#else
+#define ENV2048_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct env2048 env2048;
+
+/*
+ where observations go, a NULL buffer isn't written
+
+ boards    - packed boards, cell (x, y) is the 4-bit exponent
+             at bits 4 * (y * 4 + x), 0 is an empty cell
+ exponents - plane per cell, exponent of cell (x, y) of env i
+             at [(y * 4 + x) * n_envs + i]
+*/
+typedef struct env2048_observation {
+	uint64_t* boards;
+	uint8_t* exponents;
+} env2048_observation;
+
+/* NULL if n_envs is 0 */
+ENV2048_API env2048* env2048_create(uint32_t n_envs, uint64_t seed);
+ENV2048_API void env2048_destroy(env2048* env);
+
+ENV2048_API uint32_t env2048_count(const env2048* env);
+
+/* starts the first game of every env */
+ENV2048_API void env2048_reset(env2048* env, env2048_observation observation);
+
+/*
+ actions are 0 - up, 1 - down, 2 - left, 3 - right, anything else
+ (or a move that doesn't change the board) leaves the game as is.
+ rewards are sums of merged tile values
+*/
+ENV2048_API void env2048_step(
+	env2048* env, const uint8_t* actions,
+	env2048_observation observation,
+	uint32_t* rewards, uint8_t* terminals
+);
+
+/* bit (1 << action) is set for every action that changes the board */
+ENV2048_API void env2048_legal_masks(const env2048* env, uint8_t* masks);
+
+/* sum of the rewards of the current game of every env */
+ENV2048_API void env2048_scores(const env2048* env, uint64_t* scores);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
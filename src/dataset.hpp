@@ -0,0 +1,307 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/abort.hpp>
+#include <posix/memory.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./file_magic.hpp"
+#include "./game.hpp"
+#include "./move.hpp"
+#include "./write_file.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/*
+ columnar dataset of moves: file header, then chunks until the end
+ of the file. a chunk is dataset_chunk_header_t, then its columns
+ in this order, each padded to 8 bytes:
+
+ board      - uint64[rows], packed board before the move
+ legal      - uint8[rows], legal_moves(board)
+ action     - uint8[rows], direction value of the move
+ reward     - uint32[rows], merge score of the move
+ next_board - uint64[rows], board after the move and the new tile
+ terminal   - uint8[rows], 1 if next_board has no legal moves
+
+ with zlib compression every column is compressed separately,
+ stored_sizes are sizes in the file, before padding
+*/
+struct dataset_file_header_t {
+	file_magic_t magic;
+	uint32 reserved;
+
+	static constexpr file_magic_t expected_magic {
+		{ '2', '0', '4', '8', 'c', 'o', 'l', 's' }, 1
+	};
+};
+
+enum class dataset_compression : uint32 {
+	none = 0,
+	zlib = 1
+};
+
+static constexpr nuint dataset_columns = 6;
+
+struct dataset_chunk_header_t {
+	uint32 rows;
+	dataset_compression compression;
+	uint64 stored_sizes[dataset_columns];
+};
+
+struct dataset_chunk_t {
+	static constexpr nuint capacity = 16384;
+
+	nuint rows;
+	uint64 boards[capacity];
+	uint8 legal[capacity];
+	uint8 actions[capacity];
+	uint32 rewards[capacity];
+	uint64 next_boards[capacity];
+	uint8 terminal[capacity];
+
+	void add(board_t board, direction_t dir, uint32 reward, board_t next) {
+		boards[rows] = board.cells;
+		legal[rows] = legal_moves(board);
+		actions[rows] = dir.value;
+		rewards[rows] = reward;
+		next_boards[rows] = next.cells;
+		terminal[rows] = is_terminal(next);
+		++rows;
+	}
+
+	bool full() const { return rows == capacity; }
+};
+
+/*
+ simulation threads fill chunks from a fixed pool and submit them,
+ a dedicated thread compresses and writes them in submission order,
+ so large writes overlap with simulation. when every chunk is queued
+ submitters wait for the writer
+*/
+struct dataset_writer_t {
+	int fd = -1;
+	dataset_compression compression;
+
+	posix::memory<dataset_chunk_t> pool;
+	nuint pool_size;
+	posix::memory<dataset_chunk_t*> free_chunks;
+	nuint free_count = 0;
+	posix::memory<dataset_chunk_t*> queue;
+	nuint queue_begin = 0, queue_count = 0;
+	bool closing = false;
+
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t changed = PTHREAD_COND_INITIALIZER;
+	pthread_t thread;
+
+	posix::memory<uint8> compressed;
+
+	/* `producers` - number of threads that submit chunks */
+	dataset_writer_t(
+		const char* path, dataset_compression compression, nuint producers
+	) :
+		compression { compression },
+		pool { posix::allocate<dataset_chunk_t>(producers * 2 + 2) },
+		pool_size { producers * 2 + 2 },
+		free_chunks { posix::allocate<dataset_chunk_t*>(pool_size) },
+		queue { posix::allocate<dataset_chunk_t*>(pool_size) },
+		compressed { posix::allocate<uint8>(compressed_capacity()) }
+	{
+		for (nuint i = 0; i < pool_size; ++i) {
+			free_chunks.iterator()[free_count++] = pool.iterator() + i;
+		}
+
+#if __MINGW32__
+		int flags = O_WRONLY | O_CREAT | O_TRUNC | O_BINARY;
+#else
+		int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#endif
+		fd = open(path, flags, 0644);
+		if (fd < 0) return;
+
+		dataset_file_header_t header { dataset_file_header_t::expected_magic, 0 };
+		write_all(&header, sizeof(header));
+
+		int result = pthread_create(
+			&thread, nullptr,
+			+[](void* writer) -> void* {
+				((dataset_writer_t*) writer)->run();
+				return nullptr;
+			},
+			this
+		);
+		if (result != 0) posix::abort();
+	}
+
+	dataset_writer_t(const dataset_writer_t&) = delete;
+
+	~dataset_writer_t() {
+		if (fd < 0) return;
+
+		pthread_mutex_lock(&mutex);
+		closing = true;
+		pthread_cond_broadcast(&changed);
+		pthread_mutex_unlock(&mutex);
+
+		pthread_join(thread, nullptr);
+		close(fd);
+	}
+
+	bool valid() const { return fd >= 0; }
+
+	/* enough for every column of a chunk compressed */
+	static nuint compressed_capacity() {
+		nuint rows = dataset_chunk_t::capacity;
+		return
+			2 * compressBound(rows * 8) + 3 * compressBound(rows) +
+			compressBound(rows * 4);
+	}
+
+	/* empty chunk to fill, waits if all of them are queued */
+	dataset_chunk_t* acquire() {
+		pthread_mutex_lock(&mutex);
+		while (free_count == 0) pthread_cond_wait(&changed, &mutex);
+		dataset_chunk_t* chunk = free_chunks.iterator()[--free_count];
+		pthread_mutex_unlock(&mutex);
+
+		chunk->rows = 0;
+		return chunk;
+	}
+
+	/* returns a chunk that wasn't filled */
+	void release(dataset_chunk_t* chunk) {
+		pthread_mutex_lock(&mutex);
+		free_chunks.iterator()[free_count++] = chunk;
+		pthread_cond_broadcast(&changed);
+		pthread_mutex_unlock(&mutex);
+	}
+
+	void submit(dataset_chunk_t* chunk) {
+		pthread_mutex_lock(&mutex);
+		queue.iterator()[(queue_begin + queue_count++) % pool_size] = chunk;
+		pthread_cond_broadcast(&changed);
+		pthread_mutex_unlock(&mutex);
+	}
+
+	void write_all(const void* data, nuint size) {
+		if (!::write_all(fd, data, size)) posix::abort();
+	}
+
+	void write_padding(nuint size) {
+		static constexpr uint8 zeros[8]{};
+		if (size % 8 != 0) write_all(zeros, 8 - size % 8);
+	}
+
+	void write_chunk(const dataset_chunk_t& chunk) {
+		nuint rows = chunk.rows;
+		const void* columns[dataset_columns] {
+			chunk.boards, chunk.legal, chunk.actions,
+			chunk.rewards, chunk.next_boards, chunk.terminal
+		};
+		nuint sizes[dataset_columns] {
+			rows * 8, rows, rows, rows * 4, rows * 8, rows
+		};
+
+		if (compression == dataset_compression::none) {
+			dataset_chunk_header_t header { uint32(rows), compression, {} };
+			for (nuint i = 0; i < dataset_columns; ++i) {
+				header.stored_sizes[i] = sizes[i];
+			}
+			write_all(&header, sizeof(header));
+			for (nuint i = 0; i < dataset_columns; ++i) {
+				write_all(columns[i], sizes[i]);
+				write_padding(sizes[i]);
+			}
+			return;
+		}
+
+		dataset_chunk_header_t header { uint32(rows), compression, {} };
+		uint8* stored[dataset_columns];
+		uint8* out = compressed.iterator();
+
+		for (nuint i = 0; i < dataset_columns; ++i) {
+			uLongf stored_size = compressBound(sizes[i]);
+			if (compress2(
+				out, &stored_size, (const Bytef*) columns[i], sizes[i],
+				Z_BEST_SPEED
+			) != Z_OK) posix::abort();
+
+			stored[i] = out;
+			header.stored_sizes[i] = stored_size;
+			out += stored_size;
+		}
+
+		write_all(&header, sizeof(header));
+		for (nuint i = 0; i < dataset_columns; ++i) {
+			write_all(stored[i], header.stored_sizes[i]);
+			write_padding(header.stored_sizes[i]);
+		}
+	}
+
+	void run() {
+		pthread_mutex_lock(&mutex);
+		while (true) {
+			while (queue_count == 0 && !closing) {
+				pthread_cond_wait(&changed, &mutex);
+			}
+			if (queue_count == 0) break;
+
+			dataset_chunk_t* chunk = queue.iterator()[queue_begin];
+			queue_begin = (queue_begin + 1) % pool_size;
+			--queue_count;
+			pthread_mutex_unlock(&mutex);
+
+			write_chunk(*chunk);
+
+			pthread_mutex_lock(&mutex);
+			free_chunks.iterator()[free_count++] = chunk;
+			pthread_cond_broadcast(&changed);
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+};
+
+/*
+ adds every move of the games of a thread to the dataset,
+ the last chunk is submitted when the observer is destroyed
+*/
+struct dataset_observer_t {
+	dataset_writer_t* writer;
+	dataset_chunk_t* chunk = nullptr;
+	board_t board{};
+	uint64 score = 0;
+
+	dataset_observer_t(dataset_writer_t* writer) :
+		writer { writer },
+		chunk { writer->acquire() }
+	{}
+
+	dataset_observer_t(const dataset_observer_t&) = delete;
+
+	~dataset_observer_t() {
+		if (chunk->rows > 0) writer->submit(chunk);
+		else writer->release(chunk);
+	}
+
+	void on_begin(const basic_game_t<board_t>& game) {
+		board = game.board;
+		score = game.score;
+	}
+
+	void on_move(const basic_game_t<board_t>& game, direction_t dir) {
+		chunk->add(board, dir, uint32(game.score - score), game.board);
+		if (chunk->full()) {
+			writer->submit(chunk);
+			chunk = writer->acquire();
+		}
+		board = game.board;
+		score = game.score;
+	}
+
+	void on_end(const basic_game_t<board_t>&) {}
+};
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <integer.hpp>
+
+struct direction_t {
+	uint8 value = -1;
+	float x = 0.0; float y = 0.0;
+
+	constexpr direction_t() {}
+	constexpr direction_t(uint8 value, float x, float y) :
+		value { value }, x { x }, y { y }
+	{}
+
+	constexpr bool operator == (direction_t d) const {
+		return d.value == value;
+	}
+};
+
+static constexpr direction_t
+	invalid{},
+	up    { 0,  0.0, -1.0 },
+	down  { 1,  0.0,  1.0 },
+	left  { 2, -1.0,  0.0 },
+	right { 3,  1.0,  0.0 };
+
+static constexpr direction_t directions[] { up, down, left, right };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/memory.hpp>
+
+#include "./batch.hpp"
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./game.hpp"
+#include "./move.hpp"
+#include "./move_batch.hpp"
+
+/*
+ `count` independent games stepped together, for agents that play
+ many games at once. an env whose game is over starts the next one
+ on the same step (its done is 1, the observation is of the new game),
+ game k of env i is seeded with game_seed(seed, k * count + i)
+*/
+struct vector_env_t {
+	nuint count;
+	uint64 seed;
+	posix::memory<basic_game_t<board_t>> games;
+	posix::memory<uint32> episodes;
+
+	vector_env_t(nuint count, uint64 seed) :
+		count { count },
+		seed { seed },
+		games { posix::allocate<basic_game_t<board_t>>(count) },
+		episodes { posix::allocate<uint32>(count) }
+	{
+		reset();
+	}
+
+	basic_game_t<board_t>& game(nuint i) {
+		return games.iterator()[i];
+	}
+
+	const basic_game_t<board_t>& game(nuint i) const {
+		return games.iterator()[i];
+	}
+
+	void start_game(nuint i) {
+		game(i) = basic_game_t<board_t> {
+			game_seed(seed, uint64(episodes.iterator()[i]) * count + i)
+		};
+	}
+
+	/* every env starts its first game */
+	void reset() {
+		for (nuint i = 0; i < count; ++i) {
+			episodes.iterator()[i] = 0;
+			start_game(i);
+		}
+	}
+
+	/*
+	 steps envs [first, last) with actions (direction values),
+	 an action that doesn't move the board or isn't a direction
+	 leaves it as is with reward 0. boards are moved in chunks
+	 by move_boards
+	*/
+	void step(
+		nuint first, nuint last, const uint8* actions,
+		uint32* rewards, uint8* done
+	) {
+		static constexpr nuint chunk = 64;
+
+		board_t boards[chunk], results[chunk];
+		uint8 dirs[chunk], moved[chunk];
+		uint32 scores[chunk];
+
+		for (nuint begin = first; begin < last; begin += chunk) {
+			nuint count = last - begin < chunk ? last - begin : chunk;
+
+			for (nuint k = 0; k < count; ++k) {
+				boards[k] = game(begin + k).board;
+				dirs[k] = actions[begin + k] & 3;
+			}
+
+			move_boards(boards, dirs, count, results, scores, moved);
+
+			for (nuint k = 0; k < count; ++k) {
+				nuint i = begin + k;
+				basic_game_t<board_t>& g = game(i);
+
+				bool valid = actions[i] < 4 && moved[k];
+				rewards[i] = valid ? scores[k] : 0;
+				if (valid) g.apply_move(results[k], scores[k]);
+
+				done[i] = is_terminal(g.board);
+				if (done[i]) {
+					++episodes.iterator()[i];
+					start_game(i);
+				}
+			}
+		}
+	}
+
+	void boards(nuint first, nuint last, uint64* out) const {
+		for (nuint i = first; i < last; ++i) out[i] = game(i).board.cells;
+	}
+
+	/* score of the current game of every env */
+	void scores(nuint first, nuint last, uint64* out) const {
+		for (nuint i = first; i < last; ++i) out[i] = game(i).score;
+	}
+
+	void legal_masks(nuint first, nuint last, uint8* out) const {
+		for (nuint i = first; i < last; ++i) out[i] = legal_moves(game(i).board);
+	}
+};
\ No newline at end of file
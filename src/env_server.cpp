@@ -0,0 +1,149 @@
+#include "./posix_handlers.hpp"
+#include "./env.hpp"
+#include "./shm_env.hpp"
+#include "./thread.hpp"
+#include "./tool.hpp"
+#include "./worker_pool.hpp"
+
+#include <print/print.hpp>
+
+#include <posix/time.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static int usage() {
+	print::err(
+		"usage: 2048-env-server [--envs <count>] [--seed <seed>]\n"
+		"                       [--threads <count>] [--name </shm-name>]\n"
+	);
+	return 1;
+}
+
+int main(int argc, char** argv) {
+	uint64 envs = 1024;
+	uint64 seed = posix::get_ticks();
+	uint64 threads = hardware_threads();
+	const char* name = "/2048-env";
+
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 == argc) return usage();
+		const char* arg = argv[i];
+		const char* value = argv[++i];
+
+		if (equals(arg, "--envs")) {
+			if (
+				!try_parse_number(value, envs) ||
+				envs == 0 || envs > uint32(-1)
+			) return usage();
+		}
+		else if (equals(arg, "--seed")) {
+			if (!try_parse_number(value, seed)) return usage();
+		}
+		else if (equals(arg, "--threads")) {
+			if (!try_parse_number(value, threads) || threads == 0) return usage();
+		}
+		else if (equals(arg, "--name")) {
+			name = value;
+		}
+		else {
+			return usage();
+		}
+	}
+
+	if (threads > envs) threads = envs;
+
+	shm_env_header_t layout = shm_env_header_t::layout(envs);
+
+	int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0600);
+	if (fd < 0 || ftruncate(fd, layout.size) != 0) {
+		print::err("couldn't create shared memory ", name, "\n");
+		return 1;
+	}
+	void* mapping = mmap(
+		nullptr, layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0
+	);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		print::err("couldn't map shared memory ", name, "\n");
+		shm_unlink(name);
+		return 1;
+	}
+
+	shm_env_header_t& shared = *(shm_env_header_t*) mapping;
+	shared = layout;
+
+	vector_env_t env { envs, seed };
+	worker_pool_t pool { threads };
+
+	auto range = [&](nuint index, auto&& f) {
+		f(envs * index / threads, envs * (index + 1) / threads);
+	};
+
+	auto observe = [&](nuint first, nuint last) {
+		env.boards(first, last, shared.boards());
+		env.legal_masks(first, last, shared.legal());
+	};
+
+	auto clear = [&](nuint first, nuint last) {
+		for (nuint i = first; i < last; ++i) {
+			shared.rewards()[i] = 0;
+			shared.done()[i] = 0;
+		}
+	};
+
+	pool.run([&](nuint index) {
+		range(index, [&](nuint first, nuint last) {
+			clear(first, last);
+			observe(first, last);
+		});
+	});
+
+	/* clients check the magic, it's written last */
+	for (nuint i = 0; i < 8; ++i) {
+		__atomic_store_n(
+			&shared.magic.name[i], shm_env_header_t::expected_magic.name[i],
+			__ATOMIC_RELEASE
+		);
+	}
+
+	print::out("serving ", envs, " envs at ", name, " on ", threads, " threads\n");
+	print::out.flush();
+
+	uint32 handled = 0;
+	while (true) {
+		uint32 request = shared.request.wait_while(handled);
+		shm_env_command command = shared.command;
+
+		if (command == shm_env_command::shutdown) {
+			shared.response.store(request);
+			break;
+		}
+
+		if (command == shm_env_command::reset) {
+			env.reset();
+		}
+
+		pool.run([&](nuint index) {
+			range(index, [&](nuint first, nuint last) {
+				if (command == shm_env_command::step) {
+					env.step(
+						first, last, shared.actions(),
+						shared.rewards(), shared.done()
+					);
+				}
+				else {
+					clear(first, last);
+				}
+				observe(first, last);
+			});
+		});
+
+		handled = request;
+		shared.response.store(request);
+	}
+
+	munmap(mapping, layout.size);
+	shm_unlink(name);
+}
\ No newline at end of file
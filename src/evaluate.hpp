@@ -0,0 +1,212 @@
+#pragma once
+
+#include <integer.hpp>
+
+#include "./board.hpp"
+#include "./table_file.hpp"
+#include "./tool.hpp"
+
+/*
+ weights of the per-row heuristic terms, a board's value is the sum
+ over its 4 rows and 4 columns. `base` keeps values of live boards
+ above 0, the value of a lost board
+*/
+struct heuristic_weights_t {
+	float base = 200000.0F;
+	float empty = 270.0F;
+	float merges = 700.0F;
+	float monotonicity = 47.0F;
+	float monotonicity_power = 4.0F;
+	float smoothness = 10.0F;
+};
+
+/* terms of a single line of 4 exponents */
+inline float line_heuristic(uint16 line, const heuristic_weights_t& weights) {
+	uint8 cells[4];
+	for (nuint i = 0; i < 4; ++i) {
+		cells[i] = (line >> (4 * i)) & 0xF;
+	}
+
+	float empty = 0.0F;
+	float merges = 0.0F;
+	uint8 previous = 0;
+	nuint run = 0;
+
+	for (uint8 e : cells) {
+		if (e == 0) {
+			++empty;
+			continue;
+		}
+		if (e == previous) {
+			++run;
+		}
+		else {
+			if (run > 0) merges += 1.0F + float(run);
+			run = 0;
+			previous = e;
+		}
+	}
+	if (run > 0) merges += 1.0F + float(run);
+
+	/* weighted by a power of exponent, so big tiles out of order cost more */
+	float towards_start = 0.0F, towards_end = 0.0F;
+	float smoothness = 0.0F;
+
+	for (nuint i = 1; i < 4; ++i) {
+		float a = __builtin_powf(float(cells[i - 1]), weights.monotonicity_power);
+		float b = __builtin_powf(float(cells[i]), weights.monotonicity_power);
+		if (cells[i - 1] > cells[i]) towards_start += a - b;
+		else towards_end += b - a;
+
+		if (cells[i - 1] != 0 && cells[i] != 0) {
+			smoothness += float(
+				cells[i - 1] > cells[i] ?
+				cells[i - 1] - cells[i] :
+				cells[i] - cells[i - 1]
+			);
+		}
+	}
+
+	float monotonicity
+		= towards_start < towards_end ? towards_start : towards_end;
+
+	return
+		weights.base +
+		weights.empty * empty +
+		weights.merges * merges -
+		weights.monotonicity * monotonicity -
+		weights.smoothness * smoothness;
+}
+
+/*
+ weighted heuristic of every possible line, evaluating a board
+ is 8 lookups. `load` rebuilds the table for new weights, `try_use`
+ switches to the table of a mapped file. neither is synchronized
+ with searches that use the table
+*/
+struct heuristic_t {
+	/* table file: this header, then the lines at `lines_offset` */
+	struct file_header_t {
+		table_file_header_t file;
+		heuristic_weights_t weights;
+	};
+
+	static constexpr nuint lines_offset = 64;
+	static constexpr nuint lines_size = 65536 * sizeof(float);
+	static_assert(sizeof(file_header_t) <= lines_offset);
+
+	heuristic_weights_t weights;
+	float built_lines[65536];
+	const float* lines = built_lines;
+
+	heuristic_t(heuristic_weights_t weights = {}) {
+		load(weights);
+	}
+
+	void load(heuristic_weights_t new_weights) {
+		weights = new_weights;
+		for (nuint line = 0; line < 65536; ++line) {
+			built_lines[line] = line_heuristic(line, weights);
+		}
+		lines = built_lines;
+	}
+
+	/* false if it isn't a heuristic table file, the file must outlive its use */
+	bool try_use(const table_file_t& file) {
+		const table_file_header_t* header = file.header(table_kind::heuristic);
+		if (
+			header == nullptr ||
+			header->payload_offset != lines_offset ||
+			header->payload_size != lines_size
+		) return false;
+
+		weights = ((const file_header_t*) file.data)->weights;
+		lines = (const float*) (file.data + lines_offset);
+		return true;
+	}
+
+	/* contents of the table file for the current table */
+	posix::memory<uint8> file_image() const {
+		posix::memory<uint8> image
+			= posix::allocate<uint8>(lines_offset + lines_size);
+
+		file_header_t header {
+			table_file_header_t::of(
+				table_kind::heuristic, lines_offset, lines_size
+			),
+			weights
+		};
+		__builtin_memset(image.iterator(), 0, lines_offset);
+		__builtin_memcpy(image.iterator(), &header, sizeof(header));
+		__builtin_memcpy(image.iterator() + lines_offset, lines, lines_size);
+		return image;
+	}
+
+	float operator () (board_t board) const {
+		board_t columns = board.transposed();
+		float value = 0.0F;
+		for (nuint i = 0; i < table_rows; ++i) {
+			value += lines[board.row(i)] + lines[columns.row(i)];
+		}
+		return value;
+	}
+};
+
+inline heuristic_t heuristic{};
+
+/* static value of a board at the search horizon */
+inline float evaluate(board_t board) {
+	return heuristic(board);
+}
+
+/*
+ parses "<name> <value>" lines (e.g. "merges 700.5"), names are
+ fields of heuristic_weights_t, weights not mentioned keep their values
+*/
+inline bool try_parse_weights(
+	const uint8* text, nuint size, heuristic_weights_t& weights
+) {
+	const uint8* end = text + size;
+
+	auto skip_spaces = [&] {
+		while (text != end && (*text == ' ' || *text == '\t' || *text == '\r')) {
+			++text;
+		}
+	};
+
+	while (text != end) {
+		skip_spaces();
+		if (text == end) break;
+		if (*text == '\n') { ++text; continue; }
+
+		const uint8* name = text;
+		while (text != end && *text > ' ') ++text;
+		nuint name_size = text - name;
+
+		auto is = [&](const char* field) {
+			nuint i = 0;
+			for (; field[i] != 0; ++i) {
+				if (i == name_size || name[i] != field[i]) return false;
+			}
+			return i == name_size;
+		};
+
+		float* field =
+			is("base") ? &weights.base :
+			is("empty") ? &weights.empty :
+			is("merges") ? &weights.merges :
+			is("monotonicity") ? &weights.monotonicity :
+			is("monotonicity_power") ? &weights.monotonicity_power :
+			is("smoothness") ? &weights.smoothness :
+			nullptr;
+		if (field == nullptr) return false;
+
+		skip_spaces();
+		if (!try_parse_float(text, end, *field)) return false;
+
+		skip_spaces();
+		if (text != end && *text != '\n') return false;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/memory.hpp>
+#include <posix/time.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./evaluate.hpp"
+#include "./move.hpp"
+#include "./symmetry.hpp"
+#include "./worker_pool.hpp"
+
+/*
+ fixed-size table of evaluated chance nodes, shared by search threads
+ without locks: an entry is two 64-bit words written with relaxed atomics,
+ `check` is board ^ data, so an entry torn by concurrent writers
+ doesn't match any board and reads as a miss.
+ chance node values don't change under rotations and reflections,
+ so entries are keyed by the canonical board
+*/
+struct transposition_table_t {
+	struct entry_t {
+		uint64 check;
+		uint64 data; // depth in the upper 32 bits, value bits in the lower
+	};
+
+	posix::memory<entry_t> entries;
+	uint64 mask;
+
+	transposition_table_t(nuint size_log2) :
+		entries { posix::allocate<entry_t>(nuint(1) << size_log2) },
+		mask { (uint64(1) << size_log2) - 1 }
+	{
+		clear();
+	}
+
+	void clear() {
+		for (nuint i = 0; i <= mask; ++i) {
+			entries.iterator()[i] = entry_t{};
+		}
+	}
+
+	entry_t& entry_of(board_t board) {
+		uint64 hash = board.cells * 0x9E3779B97F4A7C15ULL;
+		return entries.iterator()[(hash >> 32) & mask];
+	}
+
+	/* value searched at least `depth` moves ahead */
+	bool try_get(board_t board, nuint depth, float& value) {
+		board = canonical(board).board;
+		entry_t& entry = entry_of(board);
+		uint64 check = __atomic_load_n(&entry.check, __ATOMIC_RELAXED);
+		uint64 data = __atomic_load_n(&entry.data, __ATOMIC_RELAXED);
+
+		if ((check ^ data) != board.cells || (data >> 32) < depth) {
+			return false;
+		}
+
+		value = __builtin_bit_cast(float, uint32(data));
+		return true;
+	}
+
+	void put(board_t board, nuint depth, float value) {
+		board = canonical(board).board;
+		entry_t& entry = entry_of(board);
+		uint64 data
+			= uint64(depth) << 32 | __builtin_bit_cast(uint32, value);
+		__atomic_store_n(&entry.check, board.cells ^ data, __ATOMIC_RELAXED);
+		__atomic_store_n(&entry.data, data, __ATOMIC_RELAXED);
+	}
+};
+
+/*
+ depth-limited expectimax recursion of a single thread,
+ depth is the number of moves ahead. chance nodes put 2 or 4
+ (1/2 each, as try_put_random_value does) into every empty cell,
+ branches less probable than `min_probability` are cut and evaluated
+ statically
+*/
+struct expectimax_search_t {
+	transposition_table_t& table;
+	float min_probability;
+	/*
+	 the search unwinds once the deadline (0 - none) passes or `stopped`
+	 is set by another thread, values it returns are meaningless then
+	*/
+	posix::ticks_t deadline = 0;
+	bool* stopped = nullptr;
+
+	uint64 nodes = 0;
+	uint64 table_hits = 0;
+	nuint checks = 0;
+
+	bool out_of_time() {
+		if (deadline == 0) return false;
+		if (__atomic_load_n(stopped, __ATOMIC_RELAXED)) return true;
+		if (++checks % 1024 == 0 && posix::get_ticks() >= deadline) {
+			__atomic_store_n(stopped, true, __ATOMIC_RELAXED);
+			return true;
+		}
+		return false;
+	}
+
+	float max_node(board_t board, nuint depth, float probability) {
+		++nodes;
+		uint8 legal = legal_moves(board);
+		float best = 0.0F;
+
+		for (direction_t dir : directions) {
+			if ((legal & (1 << dir.value)) == 0) continue;
+
+			float value = chance_node(
+				move_board(board, dir), depth, probability
+			);
+			best = value > best ? value : best;
+		}
+
+		return best;
+	}
+
+	float chance_node(board_t board, nuint depth, float probability) {
+		if (depth == 0 || probability < min_probability) {
+			return evaluate(board);
+		}
+
+		float value;
+		if (table.try_get(board, depth, value)) {
+			++table_hits;
+			return value;
+		}
+
+		if (out_of_time()) return 0.0F;
+		++nodes;
+
+		uint64 empty = board.empty_mask();
+		nuint empty_count = __builtin_popcountll(empty);
+		float cell_probability = probability / float(empty_count);
+
+		float sum = 0.0F;
+		for (; empty != 0; empty &= empty - 1) {
+			nuint shift = __builtin_ctzll(empty);
+			for (uint64 e = 1; e <= 2; ++e) {
+				sum += 0.5F * max_node(
+					board_t { board.cells | e << shift },
+					depth - 1,
+					cell_probability * 0.5F
+				);
+			}
+		}
+
+		value = sum / float(empty_count);
+		if (deadline != 0 && __atomic_load_n(stopped, __ATOMIC_RELAXED)) {
+			return 0.0F;
+		}
+		table.put(board, depth, value);
+		return value;
+	}
+};
+
+struct expectimax_t {
+	transposition_table_t table;
+	/* search threads, started once and reused by every search */
+	worker_pool_t pool;
+
+	float min_probability = 0.0001F;
+	nuint max_depth = 8;
+
+	uint64 nodes = 0;
+	uint64 table_hits = 0;
+
+	/* see expectimax_search_t, `stopped` is set if the deadline passed */
+	posix::ticks_t deadline = 0;
+	bool stopped = false;
+
+	expectimax_t(nuint table_size_log2 = 20, nuint threads = 1) :
+		table { table_size_log2 },
+		pool { threads }
+	{}
+
+	/* best direction when searching `depth` moves ahead, invalid if none */
+	direction_t best_move_at_depth(board_t board, nuint depth, float& value) {
+		if (pool.count > 1 && depth > 1) {
+			return parallel_best_move_at_depth(board, depth, value);
+		}
+
+		expectimax_search_t search {
+			table, min_probability, deadline, &stopped
+		};
+
+		uint8 legal = legal_moves(board);
+		direction_t best = invalid;
+		value = 0.0F;
+
+		for (direction_t dir : directions) {
+			if ((legal & (1 << dir.value)) == 0) continue;
+
+			float dir_value
+				= search.chance_node(move_board(board, dir), depth, 1.0F);
+			if (best == invalid || dir_value > value) {
+				best = dir;
+				value = dir_value;
+			}
+		}
+
+		nodes += search.nodes;
+		table_hits += search.table_hits;
+		return best;
+	}
+
+	/*
+	 the root move, the spawn after it and the reply move are expanded
+	 up front (up to 4 * 32 * 4 independent subtrees), threads take
+	 subtrees from a shared counter and share the transposition table.
+	 values are combined exactly as the sequential recursion does
+	*/
+	direction_t parallel_best_move_at_depth(
+		board_t board, nuint depth, float& value
+	) {
+		struct spawn_t {
+			uint8 dir;
+			float weight;
+			float best;
+		};
+
+		struct task_t {
+			board_t board;
+			float probability;
+			uint16 spawn;
+			float value;
+		};
+
+		spawn_t spawns[4 * 32];
+		task_t tasks[4 * 32 * 4];
+		nuint spawn_count = 0, task_count = 0;
+
+		uint8 legal = legal_moves(board);
+
+		for (direction_t dir : directions) {
+			if ((legal & (1 << dir.value)) == 0) continue;
+
+			board_t moved = move_board(board, dir);
+			uint64 empty = moved.empty_mask();
+			nuint empty_count = __builtin_popcountll(empty);
+			float weight = 0.5F / float(empty_count);
+
+			for (; empty != 0; empty &= empty - 1) {
+				nuint shift = __builtin_ctzll(empty);
+				for (uint64 e = 1; e <= 2; ++e) {
+					board_t spawned { moved.cells | e << shift };
+					uint8 reply_legal = legal_moves(spawned);
+
+					for (direction_t reply : directions) {
+						if ((reply_legal & (1 << reply.value)) == 0) continue;
+						tasks[task_count++] = task_t {
+							move_board(spawned, reply), weight, uint16(spawn_count), 0.0F
+						};
+					}
+
+					spawns[spawn_count++] = spawn_t { dir.value, weight, 0.0F };
+				}
+			}
+		}
+
+		nuint next_task = 0;
+		uint64 total_nodes = 0, total_hits = 0;
+
+		pool.run([&](nuint) {
+			expectimax_search_t search {
+				table, min_probability, deadline, &stopped
+			};
+
+			while (true) {
+				nuint i = __atomic_fetch_add(&next_task, 1, __ATOMIC_RELAXED);
+				if (i >= task_count) break;
+
+				task_t& task = tasks[i];
+				task.value = search.chance_node(
+					task.board, depth - 1, task.probability
+				);
+			}
+
+			__atomic_fetch_add(&total_nodes, search.nodes, __ATOMIC_RELAXED);
+			__atomic_fetch_add(&total_hits, search.table_hits, __ATOMIC_RELAXED);
+		});
+
+		nodes += total_nodes;
+		table_hits += total_hits;
+
+		for (nuint i = 0; i < task_count; ++i) {
+			spawn_t& spawn = spawns[tasks[i].spawn];
+			spawn.best = tasks[i].value > spawn.best ? tasks[i].value : spawn.best;
+		}
+
+		float dir_values[4]{};
+		for (nuint i = 0; i < spawn_count; ++i) {
+			dir_values[spawns[i].dir] += spawns[i].weight * spawns[i].best;
+		}
+
+		direction_t best = invalid;
+		value = 0.0F;
+
+		for (direction_t dir : directions) {
+			if ((legal & (1 << dir.value)) == 0) continue;
+
+			if (best == invalid || dir_values[dir.value] > value) {
+				best = dir;
+				value = dir_values[dir.value];
+			}
+		}
+
+		return best;
+	}
+
+	/*
+	 iterative deepening within `budget_ms`: a depth that doesn't finish
+	 by the deadline is stopped and the last finished one is used
+	 (depth 1 always finishes). the next depth isn't started when
+	 the growth of the last one predicts it won't fit
+	*/
+	direction_t best_move(board_t board, nuint budget_ms) {
+		posix::ticks_t begin = posix::get_ticks();
+		posix::ticks_t budget
+			= posix::ticks_t(budget_ms) * posix::ticks_per_second / 1000;
+
+		direction_t best = invalid;
+		posix::ticks_t previous_spent = 0;
+
+		for (nuint depth = 1; depth <= max_depth; ++depth) {
+			posix::ticks_t depth_begin = posix::get_ticks();
+			deadline = depth == 1 ? 0 : begin + budget;
+			stopped = false;
+
+			float value;
+			direction_t dir = best_move_at_depth(board, depth, value);
+			if (stopped) break;
+
+			best = dir;
+			if (best == invalid) break;
+
+			posix::ticks_t now = posix::get_ticks();
+			posix::ticks_t spent = now - depth_begin;
+			posix::ticks_t growth = previous_spent == 0 ?
+				2 : (spent + previous_spent - 1) / previous_spent;
+			previous_spent = spent == 0 ? 1 : spent;
+
+			if (now - begin + spent * (growth < 2 ? 2 : growth) > budget) break;
+		}
+
+		deadline = 0;
+		return best;
+	}
+};
+
+/*
+ policy for play_games, games on the same thread share one solver
+ (its transposition table and search threads, created on the first move),
+ copies of the policy only keep settings
+*/
+struct expectimax_policy_t {
+	nuint budget_ms = 10;
+	nuint max_depth = 8;
+	nuint search_threads = 1;
+
+	direction_t operator () (board_t board, auto&) {
+		static thread_local expectimax_t solver { 20, search_threads };
+		solver.max_depth = max_depth;
+		return solver.best_move(board, budget_ms);
+	}
+};
\ No newline at end of file
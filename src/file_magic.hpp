@@ -0,0 +1,17 @@
+#pragma once
+
+#include <integer.hpp>
+
+/*
+ start of every file format (and of the environment server's shared
+ memory): 8 characters naming the format and its version. a header
+ is valid only if both are equal to the expected ones
+*/
+struct file_magic_t {
+	uint8 name[8];
+	uint32 version;
+
+	constexpr bool operator == (const file_magic_t&) const = default;
+};
+
+static_assert(sizeof(file_magic_t) == 12);
\ No newline at end of file
@@ -314,13 +314,13 @@ inline void frame(
 
 			float t = 1.0;
 
-			if (game_state == game_state::animating) {
+			if (game.state == game_state_t::animating) {
 				auto new_time = posix::get_ticks();
-				nuint diff_ms = (new_time - animation_begin_time) * 1000 / posix::ticks_per_second;
+				nuint diff_ms = (new_time - game.animation_begin_time) * 1000 / posix::ticks_per_second;
 
 				if (diff_ms > animation_ms) {
-					game_state = game_state::waiting_input;
-					movement_table = movement_table_t{};
+					game.state = game_state_t::waiting_input;
+					game.movement_table = movement_table_t{};
 				}
 				else {
 					t = float(diff_ms) / float(animation_ms);
@@ -413,17 +413,19 @@ inline void frame(
 
 			float tile_size = table_size / float(table_rows) / 1.1F;
 
-			auto& current_tiles =
-				game_state == game_state::animating ?
-				prev_table.tiles :
-				table.tiles;
+			table_t current_table = table_t::from_board(
+				game.state == game_state_t::animating ?
+				game.prev_board :
+				game.board
+			);
+			auto& current_tiles = current_table.tiles;
 
 			for (nuint y = 0; y < table_rows; ++y) {
 				for (nuint x = 0; x < table_rows; ++x) {
-					movement_t movement = movement_table.tiles[y][x];
 					direction_t movement_direction
-						= movement.get<is_same_as<direction_t>>();
-					nuint movement_distance = movement.get<is_same_as<nuint>>();
+						= game.movement_table.direction();
+					nuint movement_distance
+						= game.movement_table.distance(x, y);
 
 					math::vector p0
 						= math::vector { float(x), float(y) };
@@ -498,6 +500,38 @@ inline void frame(
 				}
 			}
 
+			/* score above the table, in the margin left by it */
+			float score_digit_width = numbers {
+				(extent_f[1] - table_size) / 2.0F * 0.8F, tile_size / 6.0F
+			}.min();
+
+			nuint score_digits_count = 0;
+			number { game.score }.for_each_digit(
+				number_base { 10 }, [&](auto) {
+					++score_digits_count;
+				}
+			);
+
+			nuint score_digit_index = 0;
+			number { game.score }.for_each_digit(
+				number_base { 10 },
+				[&] (nuint digit) {
+					digits_and_letters_positions_list.emplace_back(
+						math::vector<float, 3> {
+							extent_f[0] / 2.0F + score_digit_width * (
+								- float(score_digits_count) / 2.0F +
+								(0.5F + score_digit_index)
+							),
+							(extent_f[1] - table_size) / 4.0F,
+							0.5F
+						},
+						uint32('0' + digit),
+						score_digit_width
+					);
+					++score_digit_index;
+				}
+			);
+
 			vk::image_index image_index = acquire_result.get_expected();
 
 			handle<vk::command_buffer> command_buffer
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <integer.hpp>
+
+#if __MINGW32__
+#include <windows.h>
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+inline void cpu_relax() {
+#if __x86_64__ || __i386__
+	__builtin_ia32_pause();
+#endif
+}
+
+/*
+ 32-bit word that threads (or processes, when it's in shared memory)
+ wait on: waiters spin for a while, then sleep in the kernel.
+ writers only make a syscall when someone sleeps
+*/
+struct futex_word_t {
+	uint32 value;
+	uint32 sleepers;
+
+	uint32 load() const {
+		return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+	}
+
+	/* returns the value once it isn't `old` */
+	uint32 wait_while(uint32 old, nuint spins = 4096) {
+		for (nuint i = 0; i < spins; ++i) {
+			uint32 current = load();
+			if (current != old) return current;
+			cpu_relax();
+		}
+
+		__atomic_fetch_add(&sleepers, 1, __ATOMIC_SEQ_CST);
+		uint32 current;
+		while ((current = __atomic_load_n(&value, __ATOMIC_SEQ_CST)) == old) {
+#if __MINGW32__
+			WaitOnAddress(&value, &old, sizeof(old), INFINITE);
+#else
+			syscall(SYS_futex, &value, FUTEX_WAIT, old, nullptr, nullptr, 0);
+#endif
+		}
+		__atomic_fetch_sub(&sleepers, 1, __ATOMIC_SEQ_CST);
+		return current;
+	}
+
+	void wake() {
+		if (__atomic_load_n(&sleepers, __ATOMIC_SEQ_CST) == 0) return;
+#if __MINGW32__
+		WakeByAddressAll(&value);
+#else
+		syscall(SYS_futex, &value, FUTEX_WAKE, 0x7FFFFFFF, nullptr, nullptr, 0);
+#endif
+	}
+
+	void store(uint32 new_value) {
+		__atomic_store_n(&value, new_value, __ATOMIC_SEQ_CST);
+		wake();
+	}
+
+	/* returns the new value */
+	uint32 add(uint32 delta) {
+		uint32 result = __atomic_add_fetch(&value, delta, __ATOMIC_SEQ_CST);
+		wake();
+		return result;
+	}
+};
\ No newline at end of file
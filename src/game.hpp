@@ -0,0 +1,88 @@
+#pragma once
+
+#include <posix/time.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./move.hpp"
+#include "./random.hpp"
+#include "./table.hpp"
+
+enum class game_state_t {
+	waiting_input, animating
+};
+
+/*
+ everything that belongs to a single game,
+ games don't share any mutable state and can live on different threads
+*/
+template<typename Board>
+struct basic_game_t {
+	Board board{};
+	uint64 seed;
+	random_t random;
+	uint64 score = 0;
+	nuint moves = 0;
+
+	basic_game_t(uint64 seed) : seed { seed }, random { seed } {
+		board.try_put_random_value(random);
+		board.try_put_random_value(random);
+	}
+
+	/*
+	 takes a move computed elsewhere (e.g. by move_boards) and puts
+	 a new tile, `moved` has to differ from the board
+	*/
+	void apply_move(Board moved, uint32 reward) {
+		score += reward;
+		board = moved;
+		board.try_put_random_value(random);
+		++moves;
+	}
+
+	/* moves and puts a new tile, false if the board didn't change */
+	template<direction_t Dir>
+	bool try_move() {
+		auto [moved, reward] = move_with_score<Dir>(board);
+		if (moved == board) return false;
+
+		apply_move(moved, reward);
+		return true;
+	}
+
+	bool try_move(direction_t dir) {
+		switch (dir.value) {
+			case up.value    : return try_move<up>();
+			case down.value  : return try_move<down>();
+			case left.value  : return try_move<left>();
+			case right.value : return try_move<right>();
+		}
+		return false;
+	}
+};
+
+/* 4x4 game shown by the renderer, with the animation state */
+struct game_t : basic_game_t<board_t> {
+	game_state_t state = game_state_t::waiting_input;
+	posix::ticks_t animation_begin_time{};
+	board_t prev_board{};
+	movement_table_t movement_table{};
+
+	using basic_game_t::basic_game_t;
+
+	/* same as try_move, and starts animating the move from `prev_board` */
+	template<direction_t Dir>
+	bool try_move_animated(posix::ticks_t now);
+};
+
+template<direction_t Dir>
+bool game_t::try_move_animated(posix::ticks_t now) {
+	board_t before = board;
+	if (!try_move<Dir>()) return false;
+
+	prev_board = before;
+	movement_table = movement_table_of<Dir>(before);
+	state = game_state_t::animating;
+	animation_begin_time = now;
+	return true;
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
-#include <posix/unhandled.hpp>
+#include "./posix_handlers.hpp"
+
 #include <posix/abort.hpp>
 #include <vk/__internal/unexpected_handler.hpp>
 #include <glfw/__internal/unexpected_handler.hpp>
@@ -13,13 +14,6 @@ namespace vk {
 	}
 }
 
-[[noreturn]] inline void posix::unhandled_t::operator () () const {
-	posix::abort();
-}
-[[noreturn]] inline void posix::unhandled_t::operator () (posix::error) const {
-	posix::abort();
-}
-
 namespace glfw {
 
 	[[ noreturn ]]
@@ -32,15 +26,4 @@ namespace glfw {
 		posix::abort();
 	}
 
-} // glfw
-
-#if __MINGW32__
-#include <win/unhandled.hpp>
-[[ noreturn ]] inline void win::unhandled_t::operator () () const {
-	posix::abort();
-}
-
-[[ noreturn ]] inline void win::unhandled_t::operator () (win::error) const {
-	posix::abort();
-}
-#endif
\ No newline at end of file
+} // glfw
\ No newline at end of file
@@ -0,0 +1,474 @@
+#include "./posix_handlers.hpp"
+#include "./batch.hpp"
+#include "./dataset.hpp"
+#include "./direction.hpp"
+#include "./expectimax.hpp"
+#include "./mcts.hpp"
+#include "./ntuple.hpp"
+#include "./policy.hpp"
+#include "./read_file.hpp"
+#include "./replay.hpp"
+#include "./sized_board.hpp"
+#include "./thread.hpp"
+#include "./tool.hpp"
+#include "./write_file.hpp"
+
+#include <print/print.hpp>
+
+#include <posix/memory.hpp>
+#include <posix/time.hpp>
+
+#include <span.hpp>
+
+static bool try_parse_direction(char ch, direction_t& dir) {
+	switch (ch) {
+		case 'u': dir = up;    return true;
+		case 'd': dir = down;  return true;
+		case 'l': dir = left;  return true;
+		case 'r': dir = right; return true;
+	}
+	return false;
+}
+
+static int usage() {
+	print::err(
+		"usage: 2048-headless [--games <count>] [--seed <seed>]\n"
+		"                     [--threads <count>] [--size 3..8]\n"
+		"                     [--policy random|greedy|script|expectimax|mcts|ntuple]\n"
+		"                     [--script <u|d|l|r...>] [--budget-ms <ms>]\n"
+		"                     [--search-threads <count>] [--weights <path>]\n"
+		"                     [--iterations <count>] [--rollout random|greedy]\n"
+		"                     [--network <path>] [--heuristic <path>]\n"
+		"                     [--replays <path> | --dataset <path>]\n"
+		"                     [--dataset-compression none|zlib]\n"
+		"       2048-headless --save-heuristic <path> [--weights <path>]\n"
+		"       2048-headless --train <episodes> --save <path> [--seed <seed>]\n"
+		"                     [--threads <count>] [--patterns <0,1,2;3,4,5...>]\n"
+		"                     [--alpha <rate>] [--lambda <lambda>] [--horizon <moves>]\n"
+		"       2048-headless --bench-depth <depth> [--seed <seed>]\n"
+		"                     [--threads <max count>]\n"
+	);
+	return 1;
+}
+
+/*
+ wall-clock time and nodes/sec of expectimax searches `depth` moves
+ ahead on positions of a greedy game, with 1, 2, 4 ... `max_threads`
+ search threads. every run has its own solver, with an empty table.
+ speedup is the single-thread time over the time of the run
+*/
+static void bench_solver(uint64 seed, nuint max_threads, nuint depth) {
+	static constexpr nuint position_count = 8;
+	static constexpr nuint moves_between = 40;
+
+	board_t positions[position_count];
+	nuint count = 0;
+
+	basic_game_t<board_t> game { seed };
+	greedy_policy_t policy{};
+
+	while (count < position_count) {
+		if (game.moves % moves_between == 0) {
+			positions[count++] = game.board;
+		}
+		if (!game.try_move(policy(game.board, game.random))) break;
+	}
+
+	posix::ticks_t single_thread_ticks = 0;
+
+	for (nuint threads = 1; ; threads *= 2) {
+		if (threads > max_threads) threads = max_threads;
+
+		expectimax_t solver { 20, threads };
+
+		posix::ticks_t begin = posix::get_ticks();
+		for (nuint i = 0; i < count; ++i) {
+			float value;
+			solver.best_move_at_depth(positions[i], depth, value);
+		}
+		posix::ticks_t ticks = posix::get_ticks() - begin;
+		if (ticks == 0) ticks = 1;
+		if (threads == 1) single_thread_ticks = ticks;
+
+		print::out("threads: ", threads, ", nodes: ", solver.nodes);
+		print::out(", ms: ", ticks * 1000 / posix::ticks_per_second);
+		print::out(
+			", nodes/sec: ", solver.nodes * posix::ticks_per_second / ticks
+		);
+		print::out(", speedup: ");
+		print_fixed(single_thread_ticks * 100 / ticks, 2);
+		print::out("\n");
+
+		if (threads == max_threads) break;
+	}
+}
+
+int main(int argc, char** argv) {
+	uint64 games = 1;
+	uint64 seed = posix::get_ticks();
+	uint64 threads = hardware_threads();
+	uint64 size = table_rows;
+	/* expectimax searches 10 ms per move by default, mcts is unlimited */
+	uint64 budget_ms = 10;
+	bool budget_given = false;
+	uint64 search_threads = 1;
+	uint64 bench_depth = 0;
+	uint64 iterations = 1000;
+	const char* rollout_name = "random";
+	const char* network_path = nullptr;
+	const char* heuristic_path = nullptr;
+	const char* replays_path = nullptr;
+	const char* dataset_path = nullptr;
+	dataset_compression compression = dataset_compression::none;
+	const char* save_heuristic_path = nullptr;
+	const char* save_path = nullptr;
+	const char* patterns_str = nullptr;
+	uint64 train_episodes = 0;
+	uint64 horizon = 1;
+	float alpha = 0.1F;
+	float lambda = 0.0F;
+	const char* policy_name = "random";
+	const char* script_str = "";
+	const char* weights_path = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		if (i + 1 == argc) return usage();
+		const char* arg = argv[i];
+		const char* value = argv[++i];
+
+		if (equals(arg, "--games")) {
+			if (
+				!try_parse_number(value, games) ||
+				games == 0 || games > uint32(-1)
+			) return usage();
+		}
+		else if (equals(arg, "--seed")) {
+			if (!try_parse_number(value, seed)) return usage();
+		}
+		else if (equals(arg, "--threads")) {
+			if (!try_parse_number(value, threads) || threads == 0) return usage();
+		}
+		else if (equals(arg, "--size")) {
+			if (!try_parse_number(value, size)) return usage();
+		}
+		else if (equals(arg, "--budget-ms")) {
+			if (!try_parse_number(value, budget_ms)) return usage();
+			budget_given = true;
+		}
+		else if (equals(arg, "--search-threads")) {
+			if (
+				!try_parse_number(value, search_threads) ||
+				search_threads == 0
+			) return usage();
+		}
+		else if (equals(arg, "--bench-depth")) {
+			if (!try_parse_number(value, bench_depth) || bench_depth == 0) {
+				return usage();
+			}
+		}
+		else if (equals(arg, "--iterations")) {
+			if (!try_parse_number(value, iterations) || iterations == 0) {
+				return usage();
+			}
+		}
+		else if (equals(arg, "--rollout")) {
+			rollout_name = value;
+		}
+		else if (equals(arg, "--network")) {
+			network_path = value;
+		}
+		else if (equals(arg, "--replays")) {
+			replays_path = value;
+		}
+		else if (equals(arg, "--dataset")) {
+			dataset_path = value;
+		}
+		else if (equals(arg, "--dataset-compression")) {
+			if (equals(value, "none")) compression = dataset_compression::none;
+			else if (equals(value, "zlib")) compression = dataset_compression::zlib;
+			else return usage();
+		}
+		else if (equals(arg, "--heuristic")) {
+			heuristic_path = value;
+		}
+		else if (equals(arg, "--save-heuristic")) {
+			save_heuristic_path = value;
+		}
+		else if (equals(arg, "--train")) {
+			if (
+				!try_parse_number(value, train_episodes) ||
+				train_episodes == 0 || train_episodes > uint32(-1)
+			) return usage();
+		}
+		else if (equals(arg, "--save")) {
+			save_path = value;
+		}
+		else if (equals(arg, "--patterns")) {
+			patterns_str = value;
+		}
+		else if (equals(arg, "--alpha")) {
+			if (!try_parse_float(value, alpha) || alpha < 0.0F) return usage();
+		}
+		else if (equals(arg, "--lambda")) {
+			if (
+				!try_parse_float(value, lambda) ||
+				lambda < 0.0F || lambda > 1.0F
+			) {
+				return usage();
+			}
+		}
+		else if (equals(arg, "--horizon")) {
+			if (!try_parse_number(value, horizon) || horizon == 0) return usage();
+		}
+		else if (equals(arg, "--policy")) {
+			policy_name = value;
+		}
+		else if (equals(arg, "--weights")) {
+			weights_path = value;
+		}
+		else if (equals(arg, "--script")) {
+			script_str = value;
+		}
+		else {
+			return usage();
+		}
+	}
+
+	if (weights_path != nullptr) {
+		bool read;
+		posix::memory<uint8> text = try_read_file(weights_path, read);
+		if (!read) {
+			print::err("couldn't open ", weights_path, "\n");
+			return 1;
+		}
+		heuristic_weights_t weights = heuristic.weights;
+		if (!try_parse_weights(text.iterator(), text.size(), weights)) {
+			print::err("invalid weights file\n");
+			return 1;
+		}
+		heuristic.load(weights);
+	}
+
+	if (replays_path != nullptr && dataset_path != nullptr) return usage();
+
+	if (save_heuristic_path != nullptr) {
+		posix::memory<uint8> image = heuristic.file_image();
+		if (!write_file(save_heuristic_path, image.iterator(), image.size())) {
+			print::err("couldn't write ", save_heuristic_path, "\n");
+			return 1;
+		}
+		return 0;
+	}
+
+	if (heuristic_path != nullptr) {
+		/* mapped for the whole run, searches read the table in place */
+		static table_file_t heuristic_file { heuristic_path };
+		if (!heuristic.try_use(heuristic_file)) {
+			print::err("invalid heuristic file\n");
+			return 1;
+		}
+	}
+
+	if (bench_depth != 0) {
+		bench_solver(seed, threads, bench_depth);
+		return 0;
+	}
+
+	if (train_episodes != 0) {
+		if (save_path == nullptr) return usage();
+
+		if (horizon >= td_trainer_t::max_horizon) {
+			print::err(
+				"horizon can't be above ", td_trainer_t::max_horizon - 1, "\n"
+			);
+			return 1;
+		}
+		/* the lambda-return of a single move is the TD(0) target */
+		if (lambda != 0.0F && horizon == 1) {
+			print::err("--lambda needs --horizon above 1\n");
+			return 1;
+		}
+
+		tuple_pattern_t patterns[max_tuple_patterns];
+		nuint pattern_count = 0;
+		if (patterns_str == nullptr) {
+			for (const tuple_pattern_t& pattern : default_tuple_patterns) {
+				patterns[pattern_count++] = pattern;
+			}
+		}
+		else if (!try_parse_tuple_patterns(patterns_str, patterns, pattern_count)) {
+			return usage();
+		}
+
+		ntuple_network_t network {
+			span<const tuple_pattern_t>{ patterns, pattern_count }
+		};
+		td_trainer_t trainer {
+			.network = network,
+			.learning_rate = alpha,
+			.lambda = lambda,
+			.horizon = horizon,
+			.threads = threads
+		};
+
+		static constexpr nuint blocks = 10;
+		batch_result_t results[blocks];
+
+		posix::ticks_t begin = posix::get_ticks();
+		trainer.train(train_episodes, seed, results, blocks);
+		posix::ticks_t ticks = posix::get_ticks() - begin;
+
+		for (nuint b = 0; b < blocks; ++b) {
+			if (results[b].games == 0) continue;
+			print::out(
+				"episodes ", train_episodes * b / blocks + 1,
+				"..", train_episodes * (b + 1) / blocks,
+				": average score ", results[b].score / results[b].games,
+				", best tile ", uint64(1) << results[b].max_exponent(), "\n"
+			);
+		}
+		print::out(
+			"seconds: ", ticks / posix::ticks_per_second, "\n"
+		);
+
+		if (!write_file(save_path, network.data, network.size)) {
+			print::err("couldn't write ", save_path, "\n");
+			return 1;
+		}
+		return 0;
+	}
+
+	nuint script_size = 0;
+	while (script_str[script_size] != 0) ++script_size;
+
+	posix::memory<direction_t> script_storage
+		= posix::allocate<direction_t>(script_size);
+	span<direction_t> script { script_storage.iterator(), script_size };
+
+	for (nuint i = 0; i < script_size; ++i) {
+		if (!try_parse_direction(script_str[i], script[i])) return usage();
+	}
+
+	batch_result_t total{};
+	/* replay or dataset file that couldn't be created */
+	const char* unopened_path = nullptr;
+
+	auto play_games = [&](auto policy) {
+		bool played = false;
+		with_board_of_size(size, [&](auto board) {
+			using board_type = decltype(board);
+
+			auto play = [&](auto make_observer) {
+				using observer_type = decltype(make_observer());
+
+				// not every policy or observer supports every board size
+				if constexpr(requires(
+					decltype(policy)& p, board_type b, random_t& random,
+					observer_type& observer, basic_game_t<board_type>& game
+				) {
+					p(b, random);
+					observer.on_begin(game);
+				}) {
+					total = ::play_games<board_type>(
+						games, seed, threads, policy, make_observer
+					);
+					played = true;
+				}
+			};
+
+			if (replays_path != nullptr) {
+				replay_writer_t writer { replays_path };
+				if (writer.valid()) {
+					play([&] { return replay_observer_t{ &writer }; });
+				}
+				else {
+					unopened_path = replays_path;
+				}
+			}
+			else if (dataset_path != nullptr) {
+				dataset_writer_t writer { dataset_path, compression, threads };
+				if (writer.valid()) {
+					play([&] { return dataset_observer_t{ &writer }; });
+				}
+				else {
+					unopened_path = dataset_path;
+				}
+			}
+			else {
+				play([] { return null_game_observer_t{}; });
+			}
+		});
+		return played;
+	};
+
+	/* loaded only for --policy ntuple, can be large */
+	auto play_ntuple = [&] {
+		if (network_path == nullptr) return false;
+		table_file_t file { network_path };
+		ntuple_network_t network { file };
+		if (!network.valid()) {
+			print::err("invalid network file\n");
+			return false;
+		}
+		return play_games(ntuple_policy_t{ &network });
+	};
+
+	posix::ticks_t begin = posix::get_ticks();
+
+	bool played = false;
+
+	if (equals(policy_name, "random")) {
+		played = play_games(random_policy_t{});
+	}
+	else if (equals(policy_name, "greedy")) {
+		played = play_games(greedy_policy_t{});
+	}
+	else if (equals(policy_name, "script") && script_size > 0) {
+		played = play_games(scripted_policy_t{ script });
+	}
+	else if (equals(policy_name, "expectimax")) {
+		played = play_games(expectimax_policy_t{
+			.budget_ms = budget_ms,
+			.search_threads = search_threads
+		});
+	}
+	else if (equals(policy_name, "mcts") && equals(rollout_name, "random")) {
+		played = play_games(mcts_policy_t<random_policy_t>{
+			.iterations = iterations,
+			.budget_ms = budget_given ? budget_ms : 0,
+			.search_threads = search_threads
+		});
+	}
+	else if (equals(policy_name, "mcts") && equals(rollout_name, "greedy")) {
+		played = play_games(mcts_policy_t<greedy_policy_t>{
+			.iterations = iterations,
+			.budget_ms = budget_given ? budget_ms : 0,
+			.search_threads = search_threads
+		});
+	}
+
+	else if (equals(policy_name, "ntuple")) {
+		played = play_ntuple();
+	}
+
+	if (unopened_path != nullptr) {
+		print::err("couldn't open ", unopened_path, "\n");
+		return 1;
+	}
+
+	if (!played) {
+		return usage();
+	}
+
+	posix::ticks_t ticks = posix::get_ticks() - begin;
+	double seconds = seconds_of(ticks);
+
+	print::out("size: ", size, "x", size, "\n");
+	print::out("threads: ", threads, "\n");
+	print::out("games: ", total.games, "\n");
+	print::out("moves: ", total.moves, "\n");
+	print::out("average score: ", total.score / total.games, "\n");
+	print::out("best tile: ", uint64(1) << total.max_exponent(), "\n");
+	print::out("moves/sec: ", uint64(double(total.moves) / seconds), "\n");
+	print::out("games/sec: ", uint64(double(games) / seconds), "\n");
+}
\ No newline at end of file
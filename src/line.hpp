@@ -0,0 +1,79 @@
+#pragma once
+
+#include <integer.hpp>
+
+/*
+ result of moving a line of `CellBits`-bit cells (exponents),
+ cell 0 in the lowest bits
+*/
+struct line_move_t {
+	uint64 line;
+	/* sum of the values of merged tiles */
+	uint32 score;
+	/* distance travelled by the tile at cell i, 4 bits at 4 * i */
+	uint32 distances;
+};
+
+/*
+ moves a line of `Cells` cells towards cell 0 or towards the last cell,
+ a tile merges at most once per move and tiles of the largest exponent
+ a cell holds don't merge (2^15 for 4-bit cells), there are no bits for
+ the next one
+*/
+template<nuint Cells, nuint CellBits = 4>
+constexpr line_move_t move_line(uint64 line, bool to_end) {
+	static_assert(Cells >= 2 && Cells <= 8);
+	static_assert(CellBits == 4 || CellBits == 8);
+	static_assert(Cells * CellBits <= 64);
+
+	constexpr uint64 cell_mask = (uint64(1) << CellBits) - 1;
+
+	// cell order along the direction of the move
+	auto at = [&](nuint i) { return to_end ? Cells - 1 - i : i; };
+
+	uint8 result[Cells]{};
+	line_move_t move{};
+	nuint free = 0;
+	bool mergeable = false;
+
+	for (nuint i = 0; i < Cells; ++i) {
+		uint8 e = (line >> (CellBits * at(i))) & cell_mask;
+		if (e == 0) continue;
+
+		nuint new_i;
+
+		if (mergeable && result[free - 1] == e && e != cell_mask) {
+			new_i = free - 1;
+			++result[new_i];
+			move.score += uint32(1) << result[new_i];
+			mergeable = false;
+		}
+		else {
+			new_i = free++;
+			result[new_i] = e;
+			mergeable = true;
+		}
+
+		move.distances |= uint32(i - new_i) << (4 * at(i));
+	}
+
+	for (nuint i = 0; i < Cells; ++i) {
+		move.line |= uint64(result[i]) << (CellBits * at(i));
+	}
+
+	return move;
+}
+
+/* bit CellBits * i is set for every empty cell i of the line */
+template<nuint Cells, nuint CellBits = 4>
+constexpr uint64 empty_cells_of_line(uint64 line) {
+	constexpr uint64 cells_mask = [] {
+		uint64 mask = 0;
+		for (nuint i = 0; i < Cells; ++i) mask |= uint64(1) << (CellBits * i);
+		return mask;
+	}();
+	uint64 x = line | (line >> 1);
+	x |= x >> 2;
+	if constexpr(CellBits == 8) x |= x >> 4;
+	return ~x & cells_mask;
+}
\ No newline at end of file
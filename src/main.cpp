@@ -6,6 +6,7 @@
 #include "./table.hpp"
 #include "./state.hpp"
 #include "./frame.hpp"
+#include "./tool.hpp"
 
 #include <vk.hpp>
 
@@ -25,17 +26,32 @@
 #include <list.hpp>
 
 
-int main() {
-	posix::rand_seed(posix::get_ticks());
+int main(int argc, char** argv) {
+	const char* replays_path = nullptr;
 
-	table.try_put_random_value();
-	table.try_put_random_value();
+	if (argc == 3 && equals(argv[1], "--replays")) {
+		replays_path = argv[2];
+	}
+	else if (argc != 1) {
+		print::err("usage: 2048 [--replays <path>]\n");
+		return 1;
+	}
 
 	if (!glfw_instance.is_vulkan_supported()) {
 		print::err("vulkan isn't supported\n");
 		return 1;
 	}
 
+	if (replays_path != nullptr) {
+		static replay_writer_t writer { replays_path };
+		if (!writer.valid()) {
+			print::err("couldn't open ", replays_path, "\n");
+			return 1;
+		}
+		replay_writer = &writer;
+	}
+	replay_recorder.begin(game);
+
 	init_glfw_window();
 
 	window->set_key_callback(
@@ -43,36 +59,40 @@ int main() {
 			glfw::window*, glfw::key::code key, int,
 			glfw::key::action action, glfw::key::modifiers
 		) {
-			if (game_state != game_state::waiting_input) {
+			if (game.state != game_state_t::waiting_input) {
 				return;
 			}
 
 			if (action != glfw::key::action::press) return;
 
-			optional<movement_table_t> possible_movement_table{};
-			prev_table = table;
+			posix::ticks_t now = posix::get_ticks();
+
+			bool moved = false;
+			direction_t dir = invalid;
 
 			switch (key) {
 				case glfw::keys::w :
 				case glfw::keys::up :
-					possible_movement_table = table.try_move<up>();    break;
+					dir = up;    moved = game.try_move_animated<up>(now);    break;
 				case glfw::keys::s :
 				case glfw::keys::down :
-					possible_movement_table = table.try_move<down>();  break;
+					dir = down;  moved = game.try_move_animated<down>(now);  break;
 				case glfw::keys::a :
 				case glfw::keys::left :
-					possible_movement_table = table.try_move<left>();  break;
+					dir = left;  moved = game.try_move_animated<left>(now);  break;
 				case glfw::keys::d :
 				case glfw::keys::right :
-					possible_movement_table = table.try_move<right>(); break;
+					dir = right; moved = game.try_move_animated<right>(now); break;
 			}
 
-			if (possible_movement_table.has_value()) {
-				movement_table = possible_movement_table.get();
+			if (moved) {
+				replay_recorder.record(dir, game);
+			}
 
-				table.try_put_random_value();
-				game_state = game_state::animating;
-				animation_begin_time = posix::get_ticks();
+			if (moved && is_terminal(game.board)) {
+				print::out("game over, score: ", game.score, "\n");
+				print::out.flush();
+				if (replay_writer != nullptr) replay_writer->write(replay_recorder);
 			}
 		}
 	);
@@ -871,4 +891,12 @@ int main() {
 		digits_and_letters_pipeline_layout, digits_and_letters_uniform_buffer,
 		digits_and_letters_descriptor_set
 	);
+
+	/* unfinished game is recorded too */
+	if (
+		replay_writer != nullptr &&
+		game.moves > 0 && !is_terminal(game.board)
+	) {
+		replay_writer->write(replay_recorder);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/memory.hpp>
+#include <posix/time.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./move.hpp"
+#include "./policy.hpp"
+#include "./random.hpp"
+#include "./worker_pool.hpp"
+
+/*
+ monte carlo tree search over two kinds of nodes:
+ decision nodes (board waiting for a move) and chance nodes
+ (board after a move, waiting for a new tile). a decision node's
+ children are 4 consecutive chance nodes, one per direction, a chance
+ node's children are the spawns sampled so far, in a list.
+ value of a node is the score gained from it on, rollouts play
+ `RolloutPolicy` until the game is over or `max_rollout_moves`
+
+ all nodes live in a fixed arena shared by search threads, threads
+ synchronize with atomics only: visits and value sums are added,
+ children are linked in with compare-exchange. a thread walking down
+ adds `virtual_loss` visits without value to every node on its path,
+ so other threads see it as worse and take different paths
+*/
+template<typename RolloutPolicy = random_policy_t>
+struct mcts_t {
+	struct node_t {
+		board_t board;
+		uint64 value_sum;
+		uint32 visits;
+		/* decision: first of 4 chance nodes, chance: first spawn, 0 - none */
+		uint32 children;
+		/* next spawn of the same chance node */
+		uint32 next;
+		/* chance: merge score of the move that led to it */
+		uint32 reward;
+	};
+
+	static constexpr nuint max_path = 256;
+
+	posix::memory<node_t> nodes;
+	uint32 used = 0;
+	/* search threads, started once and reused by every search */
+	worker_pool_t pool;
+
+	RolloutPolicy rollout_policy{};
+	nuint iterations = 1000;
+	/* 0 - only `iterations` limit the search */
+	nuint budget_ms = 0;
+	nuint rollouts_per_leaf = 4;
+	nuint max_rollout_moves = 1000;
+	uint32 virtual_loss = 3;
+	float exploration = 1.0F;
+
+	uint64 rollouts = 0;
+
+	mcts_t(nuint capacity = nuint(1) << 20, nuint threads = 1) :
+		nodes { posix::allocate<node_t>(capacity) },
+		pool { threads }
+	{}
+
+	node_t& node(uint32 index) {
+		return nodes.iterator()[index];
+	}
+
+	/* `count` consecutive nodes, 0 if the arena is full */
+	uint32 allocate(uint32 count) {
+		uint32 index = __atomic_fetch_add(&used, count, __ATOMIC_RELAXED);
+		if (index + count > nodes.size()) return 0;
+		return index;
+	}
+
+	uint32 load_children(node_t& n) {
+		return __atomic_load_n(&n.children, __ATOMIC_ACQUIRE);
+	}
+
+	/* chance nodes for every direction, false if the arena is full */
+	bool try_expand(node_t& decision) {
+		uint32 first = allocate(4);
+		if (first == 0) return false;
+
+		for (direction_t dir : directions) {
+			move_result_t move = move_with_score(decision.board, dir);
+			node(first + dir.value) = node_t {
+				.board = move.board,
+				.value_sum = 0, .visits = 0, .children = 0, .next = 0,
+				.reward = move.score
+			};
+		}
+
+		uint32 expected = 0;
+		// lost race leaves the 4 nodes unused
+		__atomic_compare_exchange_n(
+			&decision.children, &expected, first,
+			false, __ATOMIC_RELEASE, __ATOMIC_RELAXED
+		);
+		return true;
+	}
+
+	/* upper confidence bound, children with no visits go first */
+	uint32 select_move(node_t& decision) {
+		uint8 legal = legal_moves(decision.board);
+		uint32 first = load_children(decision);
+
+		uint32 parent_visits = __atomic_load_n(&decision.visits, __ATOMIC_RELAXED);
+		uint64 parent_sum = __atomic_load_n(&decision.value_sum, __ATOMIC_RELAXED);
+		float scale = parent_visits == 0 || parent_sum == 0 ?
+			1.0F : float(parent_sum) / float(parent_visits);
+		float log_visits = __builtin_logf(float(parent_visits + 1));
+
+		uint32 best = 0;
+		float best_bound = 0.0F;
+
+		for (direction_t dir : directions) {
+			if ((legal & (1 << dir.value)) == 0) continue;
+
+			node_t& child = node(first + dir.value);
+			uint32 visits = __atomic_load_n(&child.visits, __ATOMIC_RELAXED);
+			if (visits == 0) return first + dir.value;
+
+			uint64 sum = __atomic_load_n(&child.value_sum, __ATOMIC_RELAXED);
+			float bound = float(sum) / float(visits) + exploration * scale *
+				__builtin_sqrtf(log_visits / float(visits));
+
+			if (best == 0 || bound > best_bound) {
+				best = first + dir.value;
+				best_bound = bound;
+			}
+		}
+
+		return best;
+	}
+
+	/* decision node of the sampled spawn, 0 if the arena is full */
+	uint32 sample_spawn(node_t& chance, random_t& random) {
+		board_t spawned = chance.board;
+		spawned.try_put_random_value(random);
+
+		uint32 head = load_children(chance);
+		uint32 created = 0;
+
+		while (true) {
+			for (uint32 i = head; i != 0; i = node(i).next) {
+				if (node(i).board == spawned) return i;
+			}
+
+			if (created == 0) {
+				created = allocate(1);
+				if (created == 0) return 0;
+				node(created) = node_t { spawned, 0, 0, 0, 0, 0 };
+			}
+
+			node(created).next = head;
+			if (__atomic_compare_exchange_n(
+				&chance.children, &head, created,
+				false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE
+			)) return created;
+			// other thread linked a spawn, it could be the same one
+		}
+	}
+
+	uint64 rollout(board_t board, RolloutPolicy& policy, random_t& random) {
+		uint64 score = 0;
+		for (nuint moves = 0; moves < max_rollout_moves; ++moves) {
+			direction_t dir = policy(board, random);
+			if (dir == invalid) break;
+
+			move_result_t move = move_with_score(board, dir);
+			score += move.score;
+			board = move.board;
+			board.try_put_random_value(random);
+		}
+		return score;
+	}
+
+	/* one walk from the root to a leaf, `rollouts_per_leaf` rollouts from it */
+	void iterate(RolloutPolicy& policy, random_t& random) {
+		uint32 path[max_path];
+		nuint length = 0;
+
+		uint32 current = 1; // root
+		while (true) {
+			path[length++] = current;
+			__atomic_fetch_add(&node(current).visits, virtual_loss, __ATOMIC_RELAXED);
+
+			node_t& decision = node(current);
+			if (is_terminal(decision.board) || length + 2 > max_path) break;
+
+			if (load_children(decision) == 0) {
+				try_expand(decision);
+				break;
+			}
+
+			uint32 chance = select_move(decision);
+			path[length++] = chance;
+			__atomic_fetch_add(&node(chance).visits, virtual_loss, __ATOMIC_RELAXED);
+
+			current = sample_spawn(node(chance), random);
+			if (current == 0) break;
+		}
+
+		uint32 leaf = path[length - 1];
+		uint64 sum = 0;
+		for (nuint i = 0; i < rollouts_per_leaf; ++i) {
+			sum += rollout(node(leaf).board, policy, random);
+		}
+
+		// chance node value includes its move, decision nodes don't have one
+		for (nuint i = length; i > 0; --i) {
+			node_t& n = node(path[i - 1]);
+			if (i % 2 == 0) sum += uint64(n.reward) * rollouts_per_leaf;
+
+			__atomic_fetch_add(&n.value_sum, sum, __ATOMIC_RELAXED);
+			__atomic_fetch_add(
+				&n.visits, uint32(rollouts_per_leaf) - virtual_loss,
+				__ATOMIC_RELAXED
+			);
+		}
+	}
+
+	/* most visited move from the board, invalid if there's none */
+	direction_t best_move(board_t board, uint64 seed) {
+		uint8 legal = legal_moves(board);
+		if (legal == 0) return invalid;
+		if (__builtin_popcount(legal) == 1) {
+			return directions[__builtin_ctz(legal)];
+		}
+
+		// index 0 means "none", the root is 1
+		used = 2;
+		node(1) = node_t { board, 0, 0, 0, 0, 0 };
+		rollouts = 0;
+
+		posix::ticks_t end = posix::get_ticks() +
+			posix::ticks_t(budget_ms) * posix::ticks_per_second / 1000;
+		nuint next_iteration = 0;
+
+		pool.run([&](nuint thread) {
+			splitmix64_t seeds { seed + thread };
+			random_t random { seeds.next() };
+			RolloutPolicy policy = rollout_policy;
+
+			while (
+				__atomic_fetch_add(&next_iteration, 1, __ATOMIC_RELAXED) < iterations
+			) {
+				if (budget_ms != 0 && posix::get_ticks() > end) break;
+				iterate(policy, random);
+			}
+		});
+
+		rollouts = (next_iteration < iterations ? next_iteration : iterations)
+			* rollouts_per_leaf;
+
+		uint32 first = node(1).children;
+		direction_t best = invalid;
+		uint32 best_visits = 0;
+
+		for (direction_t dir : directions) {
+			if ((legal & (1 << dir.value)) == 0) continue;
+
+			uint32 visits = first == 0 ? 0 : node(first + dir.value).visits;
+			if (best == invalid || visits > best_visits) {
+				best = dir;
+				best_visits = visits;
+			}
+		}
+
+		return best;
+	}
+};
+
+/*
+ mcts as a policy for play_games, games on the same thread share
+ one tree arena and its search threads, the arena is sized
+ for `iterations` on first use
+*/
+template<typename RolloutPolicy = random_policy_t>
+struct mcts_policy_t {
+	nuint iterations = 1000;
+	nuint budget_ms = 0;
+	nuint search_threads = 1;
+	nuint rollouts_per_leaf = 4;
+
+	direction_t operator () (board_t board, auto& random) {
+		static thread_local mcts_t<RolloutPolicy> solver {
+			iterations * 8 + 64, search_threads
+		};
+		solver.iterations = iterations;
+		solver.budget_ms = budget_ms;
+		solver.rollouts_per_leaf = rollouts_per_leaf;
+		return solver.best_move(board, random.next());
+	}
+};
\ No newline at end of file
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./line.hpp"
+
+/*
+ precomputed results of moving every possible line of 4 cells
+ (16 bits, cell 0 in the lowest nibble), so moving a whole board
+ is one lookup per row or column. the sum of the values of merged
+ tiles (same for both directions) is kept in the spare bits of
+ `rows` and `columns`, so it comes with the lookups of the move.
+ it's a multiple of 4 up to 2^16, stored as score / 4 in 15 bits
+
+ index [0] - towards cell 0 (left for rows, up for columns)
+ index [1] - towards cell 3 (right for rows, down for columns)
+*/
+struct move_tables_t {
+	/* resulting row in the lower 16 bits, score / 4 in the upper */
+	uint32 rows[2][65536];
+	/*
+	 resulting line spread into a column, cell i at bit 16 * i,
+	 score / 4 in bits 52..63 (lower 12 bits) and 36..38 (upper 3)
+	*/
+	uint64 columns[2][65536];
+	/* 2-bit distance travelled by the tile at cell i, at bit 2 * i */
+	uint8 distances[2][65536];
+	/* bit 0 - line changes moving towards cell 0, bit 1 - towards cell 3 */
+	uint8 legal[65536];
+
+	static constexpr uint64 column_cells = 0x000F000F000F000FULL;
+
+	static constexpr uint32 row_score(uint32 row) {
+		return row >> 16 << 2;
+	}
+
+	static constexpr uint32 column_score(uint64 column) {
+		return uint32((column >> 52) | ((column >> 24) & 0x7000)) << 2;
+	}
+
+	move_tables_t() {
+		for (nuint line = 0; line < 65536; ++line) {
+			this->legal[line] = 0;
+			for (nuint to_end = 0; to_end <= 1; ++to_end) {
+				line_move_t move = move_line<4>(line, to_end);
+				uint64 score = move.score / 4;
+
+				uint8 distances = 0;
+				for (nuint i = 0; i < 4; ++i) {
+					distances |= ((move.distances >> (4 * i)) & 0b11) << (2 * i);
+				}
+
+				uint64 column = 0;
+				for (nuint i = 0; i < 4; ++i) {
+					column |= uint64((move.line >> (4 * i)) & 0xF) << (16 * i);
+				}
+				column |= (score & 0xFFF) << 52 | (score >> 12) << 36;
+
+				this->rows[to_end][line] = uint32(move.line | score << 16);
+				this->columns[to_end][line] = column;
+				this->distances[to_end][line] = distances;
+				this->legal[line] |= (move.line != line) << to_end;
+			}
+		}
+	}
+};
+
+static_assert(move_tables_t::row_score(uint32(16384) << 16) == 65536);
+static_assert(
+	move_tables_t::column_score(uint64(0xFFF) << 52 | uint64(0b111) << 36)
+	== 32767 * 4
+);
+
+inline const move_tables_t move_tables{};
+
+template<direction_t Dir>
+constexpr bool is_vertical = Dir == up || Dir == down;
+
+template<direction_t Dir>
+constexpr nuint towards_end = Dir == down || Dir == right;
+
+/* rows for left/right, columns (as rows of the transposed board) for up/down */
+template<direction_t Dir>
+inline board_t lines_of(board_t board) {
+	if constexpr(is_vertical<Dir>) {
+		return board.transposed();
+	}
+	else {
+		return board;
+	}
+}
+
+/* board after the move and the sum of the values of merged tiles */
+template<typename Board>
+struct basic_move_result_t {
+	Board board;
+	uint32 score;
+};
+
+using move_result_t = basic_move_result_t<board_t>;
+
+/*
+ lines moved by move_board<Dir>, in the order of lines_of<Dir>,
+ with the score from the same lookups
+*/
+template<direction_t Dir>
+inline move_result_t move_lines(board_t lines) {
+	if constexpr(is_vertical<Dir>) {
+		const uint64* columns = move_tables.columns[towards_end<Dir>];
+		uint64 c0 = columns[lines.row(0)], c1 = columns[lines.row(1)];
+		uint64 c2 = columns[lines.row(2)], c3 = columns[lines.row(3)];
+		uint64 cells = move_tables_t::column_cells;
+		return {
+			board_t {
+				(c0 & cells)       |
+				(c1 & cells) <<  4 |
+				(c2 & cells) <<  8 |
+				(c3 & cells) << 12
+			},
+			move_tables_t::column_score(c0) + move_tables_t::column_score(c1) +
+			move_tables_t::column_score(c2) + move_tables_t::column_score(c3)
+		};
+	}
+	else {
+		const uint32* rows = move_tables.rows[towards_end<Dir>];
+		uint32 r0 = rows[lines.row(0)], r1 = rows[lines.row(1)];
+		uint32 r2 = rows[lines.row(2)], r3 = rows[lines.row(3)];
+		return {
+			board_t {
+				uint64(r0 & 0xFFFF)       |
+				uint64(r1 & 0xFFFF) << 16 |
+				uint64(r2 & 0xFFFF) << 32 |
+				uint64(r3 & 0xFFFF) << 48
+			},
+			move_tables_t::row_score(r0) + move_tables_t::row_score(r1) +
+			move_tables_t::row_score(r2) + move_tables_t::row_score(r3)
+		};
+	}
+}
+
+template<direction_t Dir>
+inline board_t move_board(board_t board) {
+	return move_lines<Dir>(lines_of<Dir>(board)).board;
+}
+
+inline board_t move_board(board_t board, direction_t dir) {
+	switch (dir.value) {
+		case up.value    : return move_board<up>(board);
+		case down.value  : return move_board<down>(board);
+		case left.value  : return move_board<left>(board);
+		case right.value : return move_board<right>(board);
+	}
+	return board;
+}
+
+/* the score doesn't depend on the direction along the lines */
+template<direction_t Dir>
+inline uint32 merge_score(board_t board) {
+	board_t lines = lines_of<Dir>(board);
+	const uint32* rows = move_tables.rows[0];
+	return
+		move_tables_t::row_score(rows[lines.row(0)]) +
+		move_tables_t::row_score(rows[lines.row(1)]) +
+		move_tables_t::row_score(rows[lines.row(2)]) +
+		move_tables_t::row_score(rows[lines.row(3)]);
+}
+
+inline uint32 merge_score(board_t board, direction_t dir) {
+	switch (dir.value) {
+		case up.value    : return merge_score<up>(board);
+		case down.value  : return merge_score<down>(board);
+		case left.value  : return merge_score<left>(board);
+		case right.value : return merge_score<right>(board);
+	}
+	return 0;
+}
+
+/* move_board and merge_score from the same lookups */
+template<direction_t Dir>
+inline move_result_t move_with_score(board_t board) {
+	return move_lines<Dir>(lines_of<Dir>(board));
+}
+
+inline move_result_t move_with_score(board_t board, direction_t dir) {
+	switch (dir.value) {
+		case up.value    : return move_with_score<up>(board);
+		case down.value  : return move_with_score<down>(board);
+		case left.value  : return move_with_score<left>(board);
+		case right.value : return move_with_score<right>(board);
+	}
+	return { board, 0 };
+}
+
+/*
+ bit (1 << dir.value) is set for every direction that changes the board,
+ 0 means the game is over
+*/
+inline uint8 legal_moves(board_t board) {
+	static_assert(up.value == 0 && down.value == 1);
+	static_assert(left.value == 2 && right.value == 3);
+
+	board_t columns = board.transposed();
+
+	uint8 horizontal =
+		move_tables.legal[board.row(0)] | move_tables.legal[board.row(1)] |
+		move_tables.legal[board.row(2)] | move_tables.legal[board.row(3)];
+	uint8 vertical =
+		move_tables.legal[columns.row(0)] | move_tables.legal[columns.row(1)] |
+		move_tables.legal[columns.row(2)] | move_tables.legal[columns.row(3)];
+
+	return vertical | horizontal << 2;
+}
+
+inline bool is_terminal(board_t board) {
+	return legal_moves(board) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <integer.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./move.hpp"
+
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+ moves every board in its own direction (actions[i] is a direction value,
+ up.value ... right.value), boards that can't move are copied as is
+
+ results[i] - board after the move
+ rewards[i] - sum of merged tile values
+ moved[i]   - 1 if the board changed, 0 otherwise
+*/
+inline void move_boards_scalar(
+	const board_t* boards, const uint8* actions, nuint count,
+	board_t* results, uint32* rewards, uint8* moved
+) {
+	for (nuint i = 0; i < count; ++i) {
+		move_result_t move
+			= move_with_score(boards[i], directions[actions[i]]);
+		rewards[i] = move.score;
+		moved[i] = move.board != boards[i];
+		results[i] = move.board;
+	}
+}
+
+#if __AVX2__
+
+/* board_t::transposed() for 4 boards */
+inline __m256i transposed_boards(__m256i x) {
+	auto and_ = [](__m256i v, uint64 mask) {
+		return _mm256_and_si256(v, _mm256_set1_epi64x(mask));
+	};
+
+	__m256i a = _mm256_or_si256(
+		and_(x, 0xF0F00F0FF0F00F0FULL),
+		_mm256_or_si256(
+			_mm256_slli_epi64(and_(x, 0x0000F0F00000F0F0ULL), 12),
+			_mm256_srli_epi64(and_(x, 0x0F0F00000F0F0000ULL), 12)
+		)
+	);
+	return _mm256_or_si256(
+		and_(a, 0xFF00FF0000FF00FFULL),
+		_mm256_or_si256(
+			_mm256_srli_epi64(and_(a, 0x00FF00FF00000000ULL), 24),
+			_mm256_slli_epi64(and_(a, 0x00000000FF00FF00ULL), 24)
+		)
+	);
+}
+
+/*
+ 4 boards per step: lines of vertical moves are taken from the transposed
+ board, every line is one gather from `columns`, which has the score too.
+ `columns` gives the transposed result, so horizontal lanes are transposed
+ back at the end
+*/
+inline void move_boards(
+	const board_t* boards, const uint8* actions, nuint count,
+	board_t* results, uint32* rewards, uint8* moved
+) {
+	static_assert(up.value == 0 && down.value == 1);
+	static_assert(left.value == 2 && right.value == 3);
+
+	const __m256i line_mask = _mm256_set1_epi64x(0xFFFF);
+	const __m256i table_size = _mm256_set1_epi64x(65536);
+	const __m256i column_cells = _mm256_set1_epi64x(move_tables_t::column_cells);
+
+	nuint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m256i board = _mm256_loadu_si256((const __m256i*) (boards + i));
+
+		uint32 packed_directions;
+		__builtin_memcpy(&packed_directions, actions + i, 4);
+		__m256i dir = _mm256_cvtepu8_epi64(
+			_mm_cvtsi32_si128(packed_directions)
+		);
+
+		// up and down, values 0 and 1
+		__m256i vertical = _mm256_cmpgt_epi64(_mm256_set1_epi64x(2), dir);
+		// down and right, odd values
+		__m256i table_offset = _mm256_mul_epu32(
+			_mm256_and_si256(dir, _mm256_set1_epi64x(1)), table_size
+		);
+
+		__m256i lines = _mm256_blendv_epi8(
+			board, transposed_boards(board), vertical
+		);
+
+		__m256i result = _mm256_setzero_si256();
+		// score / 4, see move_tables_t::column_score
+		__m256i reward = _mm256_setzero_si256();
+
+		for (int line = 0; line < 4; ++line) {
+			__m256i index = _mm256_and_si256(
+				_mm256_srli_epi64(lines, 16 * line), line_mask
+			);
+
+			__m256i column = _mm256_i64gather_epi64(
+				(const long long*) move_tables.columns,
+				_mm256_add_epi64(index, table_offset), 8
+			);
+
+			reward = _mm256_add_epi64(reward, _mm256_or_si256(
+				_mm256_srli_epi64(column, 52),
+				_mm256_and_si256(
+					_mm256_srli_epi64(column, 24), _mm256_set1_epi64x(0x7000)
+				)
+			));
+
+			result = _mm256_or_si256(result, _mm256_slli_epi64(
+				_mm256_and_si256(column, column_cells), 4 * line
+			));
+		}
+
+		// lines were spread into columns, horizontal lanes are transposed
+		result = _mm256_blendv_epi8(
+			transposed_boards(result), result, vertical
+		);
+
+		_mm256_storeu_si256((__m256i*) (results + i), result);
+		// lower halves of the 64-bit lanes
+		__m256i packed_reward = _mm256_permutevar8x32_epi32(
+			_mm256_slli_epi64(reward, 2),
+			_mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)
+		);
+		_mm_storeu_si128(
+			(__m128i*) (rewards + i), _mm256_castsi256_si128(packed_reward)
+		);
+
+		int unchanged = _mm256_movemask_pd(
+			_mm256_castsi256_pd(_mm256_cmpeq_epi64(result, board))
+		);
+		for (int lane = 0; lane < 4; ++lane) {
+			moved[i + lane] = !((unchanged >> lane) & 1);
+		}
+	}
+
+	move_boards_scalar(
+		boards + i, actions + i, count - i,
+		results + i, rewards + i, moved + i
+	);
+}
+
+#else
+
+inline void move_boards(
+	const board_t* boards, const uint8* actions, nuint count,
+	board_t* results, uint32* rewards, uint8* moved
+) {
+	move_boards_scalar(boards, actions, count, results, rewards, moved);
+}
+
+#endif
\ No newline at end of file
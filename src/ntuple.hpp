@@ -0,0 +1,382 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/memory.hpp>
+#include <span.hpp>
+
+#include "./batch.hpp"
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./game.hpp"
+#include "./move.hpp"
+#include "./symmetry.hpp"
+#include "./table_file.hpp"
+#include "./thread.hpp"
+
+static constexpr nuint max_tuple_cells = 7;
+static constexpr nuint max_tuple_patterns = 16;
+
+/* cells of the board (y * 4 + x) that index one weight table */
+struct tuple_pattern_t {
+	uint8 size;
+	uint8 cells[max_tuple_cells];
+};
+
+/* 4 6-tuples of Jaśkowski, 2 straight and 2 rectangular */
+static constexpr tuple_pattern_t default_tuple_patterns[] {
+	{ 6, { 0, 1, 2, 3, 4, 5 } },
+	{ 6, { 4, 5, 6, 7, 8, 9 } },
+	{ 6, { 0, 1, 2, 4, 5, 6 } },
+	{ 6, { 4, 5, 6, 8, 9, 10 } },
+};
+
+/* "0,1,2,3;4,5,6,7" - patterns separated by ';', cells by ',' */
+inline bool try_parse_tuple_patterns(
+	const char* str, tuple_pattern_t* patterns, nuint& count
+) {
+	count = 0;
+	while (*str != 0) {
+		if (count == max_tuple_patterns) return false;
+		tuple_pattern_t& pattern = patterns[count++];
+		pattern = {};
+
+		while (true) {
+			if (*str < '0' || *str > '9') return false;
+			uint8 cell = 0;
+			for (; *str >= '0' && *str <= '9'; ++str) {
+				cell = cell * 10 + (*str - '0');
+				if (cell >= 16) return false;
+			}
+			if (pattern.size == max_tuple_cells) return false;
+			pattern.cells[pattern.size++] = cell;
+
+			if (*str != ',') break;
+			++str;
+		}
+
+		if (*str == ';') ++str;
+		else if (*str != 0) return false;
+	}
+	return count > 0;
+}
+
+/*
+ n-tuple network, value of an afterstate is the sum of one weight
+ per pattern for each of the 8 symmetric transforms of the board,
+ so symmetric positions share weights.
+
+ the network is one block that is also its table file (table_file.hpp):
+ header, then weights of every pattern (16^size floats each)
+ at `weights_offset`. a network is either owned (new, trainable) or
+ a view of a mapped file (read-only, update() must not be called).
+ weights are read and written with relaxed atomics, threads train
+ one network without locks (hogwild)
+*/
+struct ntuple_network_t {
+	struct header_t {
+		table_file_header_t file;
+		uint32 pattern_count;
+		uint32 reserved;
+		tuple_pattern_t patterns[max_tuple_patterns];
+	};
+
+	static constexpr nuint weights_offset = 256;
+	static_assert(sizeof(header_t) <= weights_offset);
+
+	posix::memory<uint8> owned;
+	const uint8* data = nullptr;
+	nuint size = 0;
+	float* weights = nullptr;
+	nuint offsets[max_tuple_patterns]{};
+
+	/* zero weights */
+	ntuple_network_t(span<const tuple_pattern_t> patterns) :
+		owned { posix::allocate<uint8>(
+			weights_offset + weights_size(patterns) * sizeof(float)
+		) },
+		data { owned.iterator() },
+		size { owned.size() }
+	{
+		header_t& h = *(header_t*) owned.iterator();
+		h = header_t{};
+		h.file = table_file_header_t::of(
+			table_kind::ntuple_network,
+			weights_offset, size - weights_offset
+		);
+		h.pattern_count = patterns.size();
+		for (nuint i = 0; i < patterns.size(); ++i) {
+			h.patterns[i] = patterns[i];
+		}
+
+		for (nuint i = weights_offset; i < size; ++i) {
+			owned.iterator()[i] = 0;
+		}
+		init();
+	}
+
+	/* view of a mapped network file, check with valid() */
+	ntuple_network_t(const table_file_t& file) :
+		data { file.data },
+		size { file.size }
+	{
+		if (valid()) init();
+	}
+
+	static nuint weights_size(span<const tuple_pattern_t> patterns) {
+		nuint size = 0;
+		for (const tuple_pattern_t& pattern : patterns) {
+			size += nuint(1) << (4 * pattern.size);
+		}
+		return size;
+	}
+
+	const header_t& header() const {
+		return *(const header_t*) data;
+	}
+
+	span<const tuple_pattern_t> patterns() const {
+		return { header().patterns, header().pattern_count };
+	}
+
+	bool valid() const {
+		if (data == nullptr || size < weights_offset) return false;
+
+		const header_t& h = header();
+		if (
+			!h.file.valid(table_kind::ntuple_network, size) ||
+			h.file.payload_offset != weights_offset
+		) return false;
+
+		if (h.pattern_count == 0 || h.pattern_count > max_tuple_patterns) {
+			return false;
+		}
+		for (const tuple_pattern_t& pattern : patterns()) {
+			if (pattern.size == 0 || pattern.size > max_tuple_cells) return false;
+			for (nuint i = 0; i < pattern.size; ++i) {
+				if (pattern.cells[i] >= 16) return false;
+			}
+		}
+
+		return size == weights_offset + weights_size(patterns()) * sizeof(float);
+	}
+
+	void init() {
+		weights = (float*) (data + weights_offset);
+		nuint offset = 0;
+		for (nuint i = 0; i < header().pattern_count; ++i) {
+			offsets[i] = offset;
+			offset += nuint(1) << (4 * header().patterns[i].size);
+		}
+	}
+
+	/* number of weights read for one board */
+	nuint features() const {
+		return header().pattern_count * 8;
+	}
+
+	void symmetric_boards(board_t board, board_t (&boards)[8]) const {
+		for (uint8 s = 0; s < 8; ++s) {
+			boards[s] = symmetry_t{ s }.apply(board);
+		}
+	}
+
+	float& weight(nuint pattern, board_t board) const {
+		const tuple_pattern_t& p = header().patterns[pattern];
+		nuint index = 0;
+		for (nuint i = 0; i < p.size; ++i) {
+			index = index << 4 | ((board.cells >> (4 * p.cells[i])) & 0xF);
+		}
+		return weights[offsets[pattern] + index];
+	}
+
+	float value(board_t board) const {
+		board_t boards[8];
+		symmetric_boards(board, boards);
+
+		float sum = 0.0F;
+		for (nuint p = 0; p < header().pattern_count; ++p) {
+			for (board_t b : boards) {
+				sum += load(weight(p, b));
+			}
+		}
+		return sum;
+	}
+
+	static float load(float& w) {
+		float value;
+		__atomic_load(&w, &value, __ATOMIC_RELAXED);
+		return value;
+	}
+
+	/* adds delta to every weight of the board */
+	void update(board_t board, float delta) const {
+		board_t boards[8];
+		symmetric_boards(board, boards);
+
+		for (nuint p = 0; p < header().pattern_count; ++p) {
+			for (board_t b : boards) {
+				float& w = weight(p, b);
+				float updated = load(w) + delta;
+				__atomic_store(&w, &updated, __ATOMIC_RELAXED);
+			}
+		}
+	}
+};
+
+/* the move maximizing reward + value of the afterstate */
+struct ntuple_choice_t {
+	direction_t dir = invalid;
+	board_t afterstate;
+	uint32 reward = 0;
+	float value = 0.0F;
+};
+
+inline ntuple_choice_t best_afterstate(
+	const ntuple_network_t& network, board_t board
+) {
+	uint8 legal = legal_moves(board);
+	ntuple_choice_t best{};
+	float best_total = 0.0F;
+
+	for (direction_t dir : directions) {
+		if ((legal & (1 << dir.value)) == 0) continue;
+
+		auto [afterstate, reward] = move_with_score(board, dir);
+		float value = network.value(afterstate);
+
+		if (best.dir == invalid || float(reward) + value > best_total) {
+			best = { dir, afterstate, reward, value };
+			best_total = float(reward) + value;
+		}
+	}
+
+	return best;
+}
+
+struct ntuple_policy_t {
+	const ntuple_network_t* network;
+
+	direction_t operator () (board_t board, auto&) {
+		return best_afterstate(*network, board).dir;
+	}
+};
+
+/*
+ self-play afterstate TD learning. an afterstate's target is the
+ truncated lambda-return over the next `horizon` moves:
+ lambda = 0 or horizon = 1 is TD(0), r' + V(s'). updates of a state
+ wait until `horizon` more moves are played (or the game ends)
+*/
+struct td_trainer_t {
+	static constexpr nuint max_horizon = 64;
+
+	ntuple_network_t& network;
+	float learning_rate = 0.1F;
+	float lambda = 0.0F;
+	nuint horizon = 1;
+	nuint threads = 1;
+
+	struct step_t {
+		board_t afterstate;
+		float reward;
+		float value;
+	};
+
+	/* lambda-return of steps[first], steps after `count` have no value */
+	float target(const step_t* steps, nuint first, nuint count, bool ended) {
+		nuint last = first + count - 1;
+		float result;
+		if (ended) result = 0.0F;
+		else {
+			const step_t& s = steps[last % max_horizon];
+			result = s.reward + s.value;
+			--last;
+		}
+
+		for (nuint i = last; i > first; --i) {
+			const step_t& s = steps[i % max_horizon];
+			result = s.reward + (1.0F - lambda) * s.value + lambda * result;
+		}
+		return result;
+	}
+
+	void learn(board_t afterstate, float target) {
+		float error = target - network.value(afterstate);
+		network.update(
+			afterstate, learning_rate * error / float(network.features())
+		);
+	}
+
+	void play_episode(basic_game_t<board_t>& game) {
+		step_t steps[max_horizon];
+		nuint first = 0, count = 0;
+		nuint window = lambda == 0.0F || horizon == 0 ? 1 : horizon;
+		if (window >= max_horizon) window = max_horizon - 1;
+
+		while (true) {
+			ntuple_choice_t choice = best_afterstate(network, game.board);
+			if (choice.dir == invalid) break;
+
+			steps[(first + count) % max_horizon] = {
+				choice.afterstate, float(choice.reward), choice.value
+			};
+			++count;
+
+			if (count > window) {
+				learn(
+					steps[first % max_horizon].afterstate,
+					target(steps, first, count, false)
+				);
+				++first;
+				--count;
+			}
+
+			game.try_move(choice.dir);
+		}
+
+		for (; count > 0; ++first, --count) {
+			learn(
+				steps[first % max_horizon].afterstate,
+				target(steps, first, count, true)
+			);
+		}
+	}
+
+	/*
+	 plays `episodes` games, results[b] gets the b-th of `blocks`
+	 equal parts of episodes, in episode order
+	*/
+	void train(
+		uint32 episodes, uint64 seed,
+		batch_result_t* results, nuint blocks
+	) {
+		nuint thread_count = threads == 0 ? 1 : threads;
+		batch_result_t thread_results[thread_count * blocks];
+		for (nuint i = 0; i < thread_count * blocks; ++i) {
+			thread_results[i] = batch_result_t{};
+		}
+
+		uint32 next_episode = 0;
+
+		run_on_threads(thread_count, [&](nuint thread) {
+			batch_result_t* own = thread_results + thread * blocks;
+
+			while (true) {
+				uint32 episode
+					= __atomic_fetch_add(&next_episode, 1, __ATOMIC_RELAXED);
+				if (episode >= episodes) break;
+
+				basic_game_t<board_t> game { game_seed(seed, episode) };
+				play_episode(game);
+				own[uint64(episode) * blocks / episodes].add(game);
+			}
+		});
+
+		for (nuint b = 0; b < blocks; ++b) {
+			results[b] = batch_result_t{};
+			for (nuint thread = 0; thread < thread_count; ++thread) {
+				results[b] += thread_results[thread * blocks + b];
+			}
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <integer.hpp>
+
+#if __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ hardware counters of the calling thread (user space only), read with
+ perf_event_open. a counter the kernel or cpu doesn't provide
+ (or any, outside of linux) stays unavailable and reads as 0
+*/
+struct perf_counters_t {
+	static constexpr nuint count = 4;
+	static constexpr const char* names[count] {
+		"cycles", "instructions", "branch_misses", "cache_misses"
+	};
+
+	int fds[count] { -1, -1, -1, -1 };
+
+	perf_counters_t() {
+#if __linux__
+		static constexpr uint64 configs[count] {
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_BRANCH_MISSES,
+			PERF_COUNT_HW_CACHE_MISSES
+		};
+
+		for (nuint i = 0; i < count; ++i) {
+			perf_event_attr attr{};
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof(attr);
+			attr.config = configs[i];
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		}
+#endif
+	}
+
+	perf_counters_t(const perf_counters_t&) = delete;
+
+	~perf_counters_t() {
+#if __linux__
+		for (int fd : fds) if (fd >= 0) close(fd);
+#endif
+	}
+
+	bool available(nuint i) const { return fds[i] >= 0; }
+
+	bool any_available() const {
+		for (nuint i = 0; i < count; ++i) if (available(i)) return true;
+		return false;
+	}
+
+	void start() {
+#if __linux__
+		for (int fd : fds) {
+			if (fd < 0) continue;
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	/* adds counts since start() to `values` */
+	void stop(uint64 (&values)[count]) {
+#if __linux__
+		for (nuint i = 0; i < count; ++i) {
+			if (fds[i] < 0) continue;
+			ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+			uint64 value;
+			if (read(fds[i], &value, sizeof(value)) == sizeof(value)) {
+				values[i] += value;
+			}
+		}
+#else
+		(void) values;
+#endif
+	}
+};
\ No newline at end of file
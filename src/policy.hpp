@@ -0,0 +1,63 @@
+#pragma once
+
+#include <span.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./move.hpp"
+
+/*
+ policy picks the next direction for a board, using game's generator,
+ `invalid` means that no direction changes it (game is over)
+*/
+
+struct random_policy_t {
+	direction_t operator () (auto board, auto& random) {
+		uint8 legal = legal_moves(board);
+		if (legal == 0) return invalid;
+
+		nuint n = random.next(__builtin_popcount(legal));
+		return directions[__builtin_ctzll(nth_set_bit(legal, n))];
+	}
+};
+
+/* direction with the largest immediate merge score */
+struct greedy_policy_t {
+	direction_t operator () (auto board, auto&) {
+		uint8 legal = legal_moves(board);
+		direction_t best = invalid;
+		uint32 best_score = 0;
+
+		for (direction_t dir : directions) {
+			if ((legal & (1 << dir.value)) == 0) continue;
+
+			uint32 score = merge_score(board, dir);
+			if (best == invalid || score > best_score) {
+				best = dir;
+				best_score = score;
+			}
+		}
+
+		return best;
+	}
+};
+
+/* cycles through the script, skipping directions that don't move */
+struct scripted_policy_t {
+	span<direction_t> script;
+	nuint index = 0;
+
+	direction_t operator () (auto board, auto&) {
+		uint8 legal = legal_moves(board);
+		if (legal == 0) return invalid;
+
+		for (nuint tries = 0; tries < script.size(); ++tries) {
+			direction_t dir = script[index++ % script.size()];
+			if (legal & (1 << dir.value)) {
+				return dir;
+			}
+		}
+
+		return invalid;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <posix/unhandled.hpp>
+#include <posix/abort.hpp>
+
+[[noreturn]] inline void posix::unhandled_t::operator () () const {
+	posix::abort();
+}
+[[noreturn]] inline void posix::unhandled_t::operator () (posix::error) const {
+	posix::abort();
+}
+
+#if __MINGW32__
+#include <win/unhandled.hpp>
+[[ noreturn ]] inline void win::unhandled_t::operator () () const {
+	posix::abort();
+}
+
+[[ noreturn ]] inline void win::unhandled_t::operator () (win::error) const {
+	posix::abort();
+}
+#endif
\ No newline at end of file
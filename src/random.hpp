@@ -0,0 +1,86 @@
+#pragma once
+
+#include <integer.hpp>
+
+/*
+ generators are owned by a single game (or thread) and have the same shape:
+ constructor from a 64-bit seed, next() and next(bound)
+*/
+
+/* splitmix64, mostly for seeding other generators */
+struct splitmix64_t {
+	uint64 state;
+
+	constexpr explicit splitmix64_t(uint64 seed) : state { seed } {}
+
+	constexpr uint64 next() {
+		uint64 z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	/* in [0, bound) */
+	constexpr nuint next(nuint bound) {
+		return (unsigned __int128) next() * bound >> 64;
+	}
+};
+
+/* xoshiro256**, state is expanded from the seed with splitmix64 */
+struct xoshiro256_t {
+	uint64 s[4];
+
+	constexpr explicit xoshiro256_t(uint64 seed) : s{} {
+		splitmix64_t seeds { seed };
+		for (uint64& v : s) v = seeds.next();
+	}
+
+	static constexpr uint64 rotl(uint64 x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	constexpr uint64 next() {
+		uint64 result = rotl(s[1] * 5, 7) * 9;
+		uint64 t = s[1] << 17;
+
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+
+		return result;
+	}
+
+	/* in [0, bound), multiply-shift instead of modulo */
+	constexpr nuint next(nuint bound) {
+		return (unsigned __int128) next() * bound >> 64;
+	}
+
+	/*
+	 equivalent to 2^128 calls to next(), gives up to 2^128
+	 non-overlapping streams from one seeded generator
+	*/
+	constexpr void jump() {
+		constexpr uint64 polynomial[] {
+			0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+			0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+		};
+
+		uint64 jumped[4]{};
+		for (uint64 word : polynomial) {
+			for (nuint bit = 0; bit < 64; ++bit) {
+				if (word & (uint64(1) << bit)) {
+					for (nuint i = 0; i < 4; ++i) jumped[i] ^= s[i];
+				}
+				next();
+			}
+		}
+
+		for (nuint i = 0; i < 4; ++i) s[i] = jumped[i];
+	}
+};
+
+/* generator used by games */
+using random_t = xoshiro256_t;
\ No newline at end of file
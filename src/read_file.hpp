@@ -4,6 +4,10 @@
 #include <posix/abort.hpp>
 #include <posix/io.hpp>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 inline posix::memory<uint8> read_file(c_string<char> path) {
 	body<posix::file> file = posix::open_file(
 		path,
@@ -20,4 +24,39 @@ inline posix::memory<uint8> read_file(c_string<char> path) {
 	auto read = file->read_to(mem);
 	if (read != size) { posix::abort(); }
 	return mem;
+}
+
+/*
+ contents of the file, or no bytes with `read` set to false
+ if it can't be opened or read, where read_file would abort
+*/
+inline posix::memory<uint8> try_read_file(const char* path, bool& read) {
+	read = false;
+#if __MINGW32__
+	int fd = open(path, O_RDONLY | O_BINARY);
+#else
+	int fd = open(path, O_RDONLY);
+#endif
+	if (fd < 0) return posix::allocate<uint8>(0);
+
+	struct stat status;
+	if (fstat(fd, &status) != 0) {
+		close(fd);
+		return posix::allocate<uint8>(0);
+	}
+
+	nuint size = status.st_size;
+	posix::memory<uint8> mem = posix::allocate<uint8>(size);
+
+	nuint done = 0;
+	while (done < size) {
+		auto result = ::read(fd, mem.iterator() + done, size - done);
+		if (result <= 0) break;
+		done += result;
+	}
+	close(fd);
+
+	if (done != size) return posix::allocate<uint8>(0);
+	read = true;
+	return mem;
 }
\ No newline at end of file
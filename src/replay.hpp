@@ -0,0 +1,394 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/abort.hpp>
+#include <posix/memory.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./file_magic.hpp"
+#include "./game.hpp"
+#include "./random.hpp"
+#include "./table.hpp"
+#include "./write_file.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ replay archive: file header, then records of games back to back,
+ new games are appended. a game is replayed from its seed and actions,
+ every record:
+
+ record_header_t
+ actions     - 2 bits per move (direction value), 4 moves per byte,
+               first move in the lowest bits
+ overrides   - spawn_override_t[override_count], spawns that replace
+               the generated one after a move, at most one per move,
+               sorted by move. games played here don't have any
+ keyframes   - keyframe_t[moves / keyframe_interval], state after
+               every keyframe_interval moves, for seeking
+
+ every part starts at a multiple of 8 bytes
+*/
+struct replay_file_header_t {
+	file_magic_t magic;
+	uint32 reserved;
+
+	static constexpr file_magic_t expected_magic {
+		{ '2', '0', '4', '8', 'r', 'p', 'l', 'y' }, 1
+	};
+};
+
+struct replay_record_header_t {
+	/* of the whole record, multiple of 8 */
+	uint32 size;
+	uint32 moves;
+	uint64 seed;
+	uint32 override_count;
+	uint16 keyframe_interval;
+	uint16 reserved;
+};
+
+struct spawn_override_t {
+	/* the spawn after this move (0 - first move) is replaced */
+	uint32 move;
+	uint8 cell;
+	uint8 exponent;
+	uint16 reserved;
+};
+
+struct keyframe_t {
+	uint64 board;
+	uint64 score;
+	uint64 random[4];
+};
+
+static constexpr nuint default_keyframe_interval = 1024;
+
+constexpr nuint replay_align(nuint size) {
+	return (size + 7) & ~nuint(7);
+}
+
+/* bytes appended to the end, grows by doubling */
+struct byte_buffer_t {
+	uint8* data = nullptr;
+	nuint size = 0;
+	nuint capacity = 0;
+
+	byte_buffer_t() {}
+	byte_buffer_t(const byte_buffer_t&) = delete;
+	~byte_buffer_t() { free(data); }
+
+	void append(const void* bytes, nuint count) {
+		if (size + count > capacity) {
+			nuint new_capacity = capacity == 0 ? 256 : capacity * 2;
+			while (new_capacity < size + count) new_capacity *= 2;
+			uint8* grown = (uint8*) realloc(data, new_capacity);
+			if (grown == nullptr) posix::abort();
+			data = grown;
+			capacity = new_capacity;
+		}
+		__builtin_memcpy(data + size, bytes, count);
+		size += count;
+	}
+
+	void clear() { size = 0; }
+};
+
+/* record of the game being played, filled move by move, without overrides */
+struct replay_recorder_t {
+	uint64 seed = 0;
+	nuint moves = 0;
+	nuint keyframe_interval = default_keyframe_interval;
+	byte_buffer_t actions;
+	byte_buffer_t keyframes;
+
+	/* starts recording a new game, right after its first spawns */
+	void begin(const basic_game_t<board_t>& game) {
+		seed = game.seed;
+		moves = 0;
+		actions.clear();
+		keyframes.clear();
+	}
+
+	/* move that was made by the game, `game` is the state after it */
+	void record(direction_t dir, const basic_game_t<board_t>& game) {
+		if (moves % 4 == 0) {
+			uint8 zero = 0;
+			actions.append(&zero, 1);
+		}
+		actions.data[moves / 4] |= dir.value << (2 * (moves % 4));
+		++moves;
+
+		if (keyframe_interval != 0 && moves % keyframe_interval == 0) {
+			keyframe_t keyframe {
+				game.board.cells, game.score,
+				{
+					game.random.s[0], game.random.s[1],
+					game.random.s[2], game.random.s[3]
+				}
+			};
+			keyframes.append(&keyframe, sizeof(keyframe));
+		}
+	}
+
+
+	nuint record_size() const {
+		return
+			sizeof(replay_record_header_t) +
+			replay_align(actions.size) + keyframes.size;
+	}
+
+	/* writes the record to `out`, record_size() bytes */
+	void serialize(uint8* out) const {
+		replay_record_header_t header {
+			uint32(record_size()), uint32(moves), seed,
+			0,
+			uint16(keyframe_interval), 0
+		};
+		__builtin_memcpy(out, &header, sizeof(header));
+		out += sizeof(header);
+
+		__builtin_memset(out, 0, replay_align(actions.size));
+		__builtin_memcpy(out, actions.data, actions.size);
+		out += replay_align(actions.size);
+
+		__builtin_memcpy(out, keyframes.data, keyframes.size);
+	}
+};
+
+/*
+ appends records to an archive through a buffer, records of
+ different threads are written whole, in the order they finish
+*/
+struct replay_writer_t {
+	static constexpr nuint buffer_size = nuint(1) << 20;
+
+	int fd = -1;
+	posix::memory<uint8> buffer;
+	nuint used = 0;
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+	replay_writer_t(const char* path) :
+		buffer { posix::allocate<uint8>(buffer_size) }
+	{
+#if __MINGW32__
+		int flags = O_WRONLY | O_CREAT | O_APPEND | O_BINARY;
+#else
+		int flags = O_WRONLY | O_CREAT | O_APPEND;
+#endif
+		fd = open(path, flags, 0644);
+		if (fd < 0) return;
+
+		struct stat status;
+		if (fstat(fd, &status) == 0 && status.st_size == 0) {
+			replay_file_header_t header { replay_file_header_t::expected_magic, 0 };
+			append(&header, sizeof(header));
+		}
+	}
+
+	replay_writer_t(const replay_writer_t&) = delete;
+
+	~replay_writer_t() {
+		if (fd < 0) return;
+		flush();
+		close(fd);
+	}
+
+	bool valid() const { return fd >= 0; }
+
+	void write_all(const uint8* data, nuint size) {
+		if (!::write_all(fd, data, size)) posix::abort();
+	}
+
+	void flush() {
+		write_all(buffer.iterator(), used);
+		used = 0;
+	}
+
+	void append(const void* data, nuint size) {
+		if (used + size > buffer_size) flush();
+		if (size > buffer_size) {
+			write_all((const uint8*) data, size);
+			return;
+		}
+		__builtin_memcpy(buffer.iterator() + used, data, size);
+		used += size;
+	}
+
+	void write(const replay_recorder_t& recorder) {
+		nuint size = recorder.record_size();
+
+		pthread_mutex_lock(&mutex);
+		if (used + size > buffer_size) flush();
+
+		if (size > buffer_size) {
+			uint8* data = (uint8*) malloc(size);
+			recorder.serialize(data);
+			write_all(data, size);
+			free(data);
+		}
+		else {
+			recorder.serialize(buffer.iterator() + used);
+			used += size;
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+};
+
+/* records every game played on a thread, see play_games */
+struct replay_observer_t {
+	replay_writer_t* writer;
+	replay_recorder_t recorder{};
+
+	void on_begin(const basic_game_t<board_t>& game) {
+		recorder.begin(game);
+	}
+
+	void on_move(const basic_game_t<board_t>& game, direction_t dir) {
+		recorder.record(dir, game);
+	}
+
+	void on_end(const basic_game_t<board_t>&) {
+		writer->write(recorder);
+	}
+};
+
+/* a record in an archive, read in place */
+struct replay_t {
+	const replay_record_header_t* header = nullptr;
+	const uint8* actions = nullptr;
+	const spawn_override_t* overrides = nullptr;
+	const keyframe_t* keyframes = nullptr;
+
+	nuint moves() const { return header->moves; }
+
+	nuint keyframe_count() const {
+		return header->keyframe_interval == 0 ?
+			0 : header->moves / header->keyframe_interval;
+	}
+
+	direction_t action(nuint move) const {
+		return directions[(actions[move / 4] >> (2 * (move % 4))) & 3];
+	}
+
+	/* false if `size` bytes don't start with a whole valid record */
+	bool try_read(const uint8* data, nuint size) {
+		if (size < sizeof(replay_record_header_t)) return false;
+		header = (const replay_record_header_t*) data;
+		if (header->size > size || header->size % 8 != 0) return false;
+
+		nuint actions_size = replay_align((nuint(header->moves) + 3) / 4);
+		nuint expected_size =
+			sizeof(replay_record_header_t) + actions_size +
+			nuint(header->override_count) * sizeof(spawn_override_t) +
+			keyframe_count() * sizeof(keyframe_t);
+		if (header->size != expected_size) return false;
+
+		actions = data + sizeof(replay_record_header_t);
+		overrides = (const spawn_override_t*) (actions + actions_size);
+		keyframes = (const keyframe_t*) (overrides + header->override_count);
+
+		for (nuint i = 0; i < header->override_count; ++i) {
+			const spawn_override_t& o = overrides[i];
+			if (o.cell >= 16 || o.exponent == 0 || o.exponent > 0xF) {
+				return false;
+			}
+			// one override per move at most, in the order of moves
+			if (o.move >= header->moves) return false;
+			if (i > 0 && o.move <= overrides[i - 1].move) return false;
+		}
+		return true;
+	}
+
+	/*
+	 replays moves [game.moves, move) of the game through the engine,
+	 applying spawn overrides, calls f(game, dir) after every move.
+	 false if the record is invalid: `move` is past its end, an action
+	 doesn't change the board or an override puts a tile on another one
+	*/
+	bool replay(basic_game_t<board_t>& game, nuint move, auto&& f) const {
+		if (move > moves()) return false;
+
+		const spawn_override_t* o = overrides;
+		const spawn_override_t* overrides_end = overrides + header->override_count;
+		while (o != overrides_end && o->move < game.moves) ++o;
+
+		while (game.moves < move) {
+			direction_t dir = action(game.moves);
+			auto [moved, reward] = move_with_score(game.board, dir);
+			if (moved == game.board) return false;
+
+			nuint index = game.moves;
+			// the generated spawn is still drawn, so the random state matches
+			game.apply_move(moved, reward);
+
+			if (o != overrides_end && o->move == index) {
+				if (moved.exponent(o->cell % 4, o->cell / 4) != 0) return false;
+				game.board = board_t {
+					moved.cells | uint64(o->exponent) << (4 * o->cell)
+				};
+				++o;
+			}
+			f(game, dir);
+		}
+		return true;
+	}
+
+	/*
+	 state after `move` moves, from the nearest keyframe before it,
+	 false if the record is invalid (see replay)
+	*/
+	bool try_game_at(nuint move, basic_game_t<board_t>& game) const {
+		game = basic_game_t<board_t> { header->seed };
+
+		nuint keyframe = header->keyframe_interval == 0 ?
+			0 : move / header->keyframe_interval;
+		if (keyframe > keyframe_count()) keyframe = keyframe_count();
+
+		if (keyframe > 0) {
+			const keyframe_t& k = keyframes[keyframe - 1];
+			game.board = board_t { k.board };
+			game.score = k.score;
+			game.moves = keyframe * header->keyframe_interval;
+			for (nuint i = 0; i < 4; ++i) game.random.s[i] = k.random[i];
+		}
+
+		return replay(game, move, [](auto&, direction_t) {});
+	}
+
+	bool try_table_at(nuint move, table_t& table) const {
+		basic_game_t<board_t> game { header->seed };
+		if (!try_game_at(move, game)) return false;
+		table = table_t::from_board(game.board);
+		return true;
+	}
+};
+
+/* records of an archive in memory (e.g. a mapped table_file_t) */
+struct replay_archive_t {
+	const uint8* data;
+	nuint size;
+
+	bool valid() const {
+		if (size < sizeof(replay_file_header_t)) return false;
+		auto header = (const replay_file_header_t*) data;
+		return header->magic == replay_file_header_t::expected_magic;
+	}
+
+	/* offset of the first record */
+	static constexpr nuint begin = sizeof(replay_file_header_t);
+
+	/* record at `offset`, moves offset to the next one, false at the end */
+	bool try_next(nuint& offset, replay_t& replay) const {
+		if (offset >= size || !replay.try_read(data + offset, size - offset)) {
+			return false;
+		}
+		offset += replay.header->size;
+		return true;
+	}
+};
\ No newline at end of file
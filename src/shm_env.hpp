@@ -0,0 +1,133 @@
+#pragma once
+
+#include <integer.hpp>
+
+#include "./file_magic.hpp"
+#include "./futex.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ shared memory of the environment server (env_server.cpp):
+ header, then arrays of `envs` elements, every one 64-byte aligned
+
+ actions - uint8, written by the agent before a request
+ boards  - uint64, packed board of every env
+ rewards - uint32, reward of the last step
+ done    - uint8, 1 if the last step ended a game (see vector_env_t)
+ legal   - uint8, legal_moves of every board
+
+ the agent writes actions and `command`, then increments `request`,
+ the server answers by setting `response` to the same value.
+ both sides wait by spinning, then sleeping on a futex
+*/
+enum class shm_env_command : uint32 {
+	step = 1,
+	reset = 2,
+	shutdown = 3
+};
+
+struct shm_env_header_t {
+	file_magic_t magic;
+	uint32 envs;
+
+	uint64 actions_offset;
+	uint64 boards_offset;
+	uint64 rewards_offset;
+	uint64 done_offset;
+	uint64 legal_offset;
+	uint64 size;
+
+	shm_env_command command;
+
+	alignas(64) futex_word_t request;
+	alignas(64) futex_word_t response;
+
+	static constexpr file_magic_t expected_magic {
+		{ '2', '0', '4', '8', 's', 'e', 'n', 'v' }, 1
+	};
+
+	static shm_env_header_t layout(uint32 envs) {
+		auto align = [](uint64 offset) { return (offset + 63) & ~uint64(63); };
+
+		shm_env_header_t h{};
+		h.magic.version = expected_magic.version;
+		h.envs = envs;
+		h.actions_offset = align(sizeof(shm_env_header_t));
+		h.boards_offset = align(h.actions_offset + envs);
+		h.rewards_offset = align(h.boards_offset + envs * sizeof(uint64));
+		h.done_offset = align(h.rewards_offset + envs * sizeof(uint32));
+		h.legal_offset = align(h.done_offset + envs);
+		h.size = align(h.legal_offset + envs);
+		return h;
+	}
+
+	bool valid(nuint mapped_size) const {
+		return
+			magic == expected_magic &&
+			size <= mapped_size &&
+			layout(envs).size == size;
+	}
+
+	uint8* base() { return (uint8*) this; }
+
+	uint8* actions() { return base() + actions_offset; }
+	uint64* boards() { return (uint64*) (base() + boards_offset); }
+	uint32* rewards() { return (uint32*) (base() + rewards_offset); }
+	uint8* done() { return base() + done_offset; }
+	uint8* legal() { return base() + legal_offset; }
+};
+
+/* agent side, arrays are used in place */
+struct shm_env_client_t {
+	shm_env_header_t* header = nullptr;
+	nuint size = 0;
+
+	/* header is nullptr if there's no server with the name */
+	shm_env_client_t(const char* name) {
+		int fd = shm_open(name, O_RDWR, 0);
+		if (fd < 0) return;
+
+		struct stat status;
+		if (fstat(fd, &status) == 0 && status.st_size > 0) {
+			void* mapping = mmap(
+				nullptr, status.st_size,
+				PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0
+			);
+			if (mapping != MAP_FAILED) {
+				header = (shm_env_header_t*) mapping;
+				size = status.st_size;
+			}
+		}
+		close(fd);
+
+		if (header != nullptr && !header->valid(size)) {
+			munmap(header, size);
+			header = nullptr;
+		}
+	}
+
+	shm_env_client_t(const shm_env_client_t&) = delete;
+
+	~shm_env_client_t() {
+		if (header != nullptr) munmap(header, size);
+	}
+
+	/* sends the command and waits for the server to finish it */
+	void call(shm_env_command command) {
+		header->command = command;
+		uint32 request = header->request.add(1);
+
+		uint32 response;
+		while ((response = header->response.load()) != request) {
+			header->response.wait_while(response);
+		}
+	}
+
+	void step() { call(shm_env_command::step); }
+	void reset() { call(shm_env_command::reset); }
+	void shutdown() { call(shm_env_command::shutdown); }
+};
\ No newline at end of file
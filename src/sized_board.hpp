@@ -0,0 +1,253 @@
+#pragma once
+
+#include <integer.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+#include "./line.hpp"
+#include "./move.hpp"
+
+/*
+ board of Rows x Rows cells for sizes other than the default 4x4 (board_t),
+ every row is a line of exponents, cell x at bits cell_bits * x.
+ boards up to 4x4 have 4-bit cells, on larger ones tiles get past 2^15
+ (the largest 4-bit exponent, it doesn't merge), so they have 8-bit cells
+*/
+template<nuint Rows>
+struct sized_board_t {
+	static_assert(Rows >= 2 && Rows <= 8);
+
+	static constexpr nuint cell_bits = Rows <= 4 ? 4 : 8;
+	static constexpr uint64 cell_mask = (uint64(1) << cell_bits) - 1;
+
+	uint64 lines[Rows]{};
+
+	constexpr bool operator == (const sized_board_t&) const = default;
+
+	constexpr uint8 exponent(nuint x, nuint y) const {
+		return (lines[y] >> (cell_bits * x)) & cell_mask;
+	}
+
+	constexpr void exponent(nuint x, nuint y, uint8 e) {
+		nuint shift = cell_bits * x;
+		lines[y] = (lines[y] & ~(cell_mask << shift)) | (e & cell_mask) << shift;
+	}
+
+	constexpr uint64 row(nuint y) const {
+		return lines[y];
+	}
+
+	constexpr sized_board_t transposed() const {
+		sized_board_t result{};
+		for (nuint y = 0; y < Rows; ++y) {
+			for (nuint x = 0; x < Rows; ++x) {
+				result.lines[x] |= uint64(exponent(x, y)) << (cell_bits * y);
+			}
+		}
+		return result;
+	}
+
+	constexpr nuint empty_count() const {
+		nuint count = 0;
+		for (uint64 line : lines) {
+			count += __builtin_popcountll(
+				empty_cells_of_line<Rows, cell_bits>(line)
+			);
+		}
+		return count;
+	}
+
+	constexpr uint8 max_exponent() const {
+		uint8 max = 0;
+		for (nuint y = 0; y < Rows; ++y) {
+			for (nuint x = 0; x < Rows; ++x) {
+				max = exponent(x, y) > max ? exponent(x, y) : max;
+			}
+		}
+		return max;
+	}
+
+	bool try_put_random_value(auto& random) {
+		nuint count = empty_count();
+		if (count == 0) return false;
+
+		nuint choice = random.next(count * 2);
+		nuint n = choice >> 1;
+
+		for (uint64& line : lines) {
+			uint64 empty = empty_cells_of_line<Rows, cell_bits>(line);
+			nuint line_count = __builtin_popcountll(empty);
+
+			if (n < line_count) {
+				uint64 cell_bit = nth_set_bit(empty, n);
+				line |= uint64((choice & 1) + 1) << __builtin_ctzll(cell_bit);
+				return true;
+			}
+
+			n -= line_count;
+		}
+
+		return false;
+	}
+};
+
+/* lookup tables for lines that fit 16 bits, same layout as move_tables_t */
+template<nuint Cells>
+struct line_tables_t {
+	static_assert(Cells <= 4);
+	static constexpr nuint size = nuint(1) << (4 * Cells);
+
+	uint16 lines[2][size];
+	uint32 scores[size];
+
+	line_tables_t() {
+		for (nuint line = 0; line < size; ++line) {
+			for (nuint to_end = 0; to_end <= 1; ++to_end) {
+				line_move_t move = move_line<Cells>(line, to_end);
+				this->lines[to_end][line] = move.line;
+				this->scores[line] = move.score;
+			}
+		}
+	}
+};
+
+template<nuint Cells>
+inline const line_tables_t<Cells> line_tables{};
+
+/*
+ move kernel chosen at compile time: lookup tables for small boards,
+ the unrolled line move for the rest (tables would be 2^20+ entries)
+*/
+template<nuint Rows, bool ToEnd>
+inline line_move_t sized_move_line(uint64 line) {
+	if constexpr(Rows <= 4) {
+		return {
+			.line = line_tables<Rows>.lines[ToEnd][line],
+			.score = line_tables<Rows>.scores[line],
+			.distances = 0
+		};
+	}
+	else {
+		return move_line<Rows, sized_board_t<Rows>::cell_bits>(line, ToEnd);
+	}
+}
+
+template<direction_t Dir, nuint Rows>
+inline sized_board_t<Rows> move_board(sized_board_t<Rows> board) {
+	sized_board_t<Rows> lines = is_vertical<Dir> ? board.transposed() : board;
+
+	sized_board_t<Rows> result{};
+	for (nuint i = 0; i < Rows; ++i) {
+		result.lines[i]
+			= sized_move_line<Rows, towards_end<Dir>>(lines.lines[i]).line;
+	}
+
+	return is_vertical<Dir> ? result.transposed() : result;
+}
+
+template<direction_t Dir, nuint Rows>
+inline uint32 merge_score(sized_board_t<Rows> board) {
+	sized_board_t<Rows> lines = is_vertical<Dir> ? board.transposed() : board;
+
+	uint32 score = 0;
+	for (nuint i = 0; i < Rows; ++i) {
+		score += sized_move_line<Rows, towards_end<Dir>>(lines.lines[i]).score;
+	}
+	return score;
+}
+
+template<direction_t Dir, nuint Rows>
+inline basic_move_result_t<sized_board_t<Rows>> move_with_score(
+	sized_board_t<Rows> board
+) {
+	sized_board_t<Rows> lines = is_vertical<Dir> ? board.transposed() : board;
+
+	basic_move_result_t<sized_board_t<Rows>> result{};
+	for (nuint i = 0; i < Rows; ++i) {
+		line_move_t move
+			= sized_move_line<Rows, towards_end<Dir>>(lines.lines[i]);
+		result.board.lines[i] = move.line;
+		result.score += move.score;
+	}
+
+	if constexpr(is_vertical<Dir>) {
+		result.board = result.board.transposed();
+	}
+	return result;
+}
+
+template<nuint Rows>
+inline sized_board_t<Rows> move_board(
+	sized_board_t<Rows> board, direction_t dir
+) {
+	switch (dir.value) {
+		case up.value    : return move_board<up>(board);
+		case down.value  : return move_board<down>(board);
+		case left.value  : return move_board<left>(board);
+		case right.value : return move_board<right>(board);
+	}
+	return board;
+}
+
+template<nuint Rows>
+inline uint32 merge_score(sized_board_t<Rows> board, direction_t dir) {
+	switch (dir.value) {
+		case up.value    : return merge_score<up>(board);
+		case down.value  : return merge_score<down>(board);
+		case left.value  : return merge_score<left>(board);
+		case right.value : return merge_score<right>(board);
+	}
+	return 0;
+}
+
+template<nuint Rows>
+inline basic_move_result_t<sized_board_t<Rows>> move_with_score(
+	sized_board_t<Rows> board, direction_t dir
+) {
+	switch (dir.value) {
+		case up.value    : return move_with_score<up>(board);
+		case down.value  : return move_with_score<down>(board);
+		case left.value  : return move_with_score<left>(board);
+		case right.value : return move_with_score<right>(board);
+	}
+	return { board, 0 };
+}
+
+template<nuint Rows>
+inline uint8 legal_moves(sized_board_t<Rows> board) {
+	sized_board_t<Rows> columns = board.transposed();
+	uint8 horizontal = 0, vertical = 0;
+
+	for (nuint i = 0; i < Rows; ++i) {
+		for (nuint to_end = 0; to_end <= 1; ++to_end) {
+			uint64 row = board.lines[i], column = columns.lines[i];
+			constexpr nuint bits = sized_board_t<Rows>::cell_bits;
+			horizontal |= (move_line<Rows, bits>(row, to_end).line != row) << to_end;
+			vertical |= (move_line<Rows, bits>(column, to_end).line != column) << to_end;
+		}
+	}
+
+	return vertical | horizontal << 2;
+}
+
+template<nuint Rows>
+inline bool is_terminal(sized_board_t<Rows> board) {
+	return legal_moves(board) == 0;
+}
+
+/*
+ runtime dispatch to the instantiation for the board size,
+ calls f with an empty board of that size (board_t for 4x4),
+ false if the size isn't supported
+*/
+inline bool with_board_of_size(nuint rows, auto&& f) {
+	switch (rows) {
+		case 3: f(sized_board_t<3>{}); return true;
+		case 4: f(board_t{});          return true;
+		case 5: f(sized_board_t<5>{}); return true;
+		case 6: f(sized_board_t<6>{}); return true;
+		case 7: f(sized_board_t<7>{}); return true;
+		case 8: f(sized_board_t<8>{}); return true;
+	}
+	return false;
+}
\ No newline at end of file
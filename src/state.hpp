@@ -1,14 +1,12 @@
 #pragma once
 
 #include <posix/time.hpp>
-#include "./table.hpp"
+#include "./game.hpp"
+#include "./replay.hpp"
 
-static enum class game_state {
-	waiting_input, animating
-} game_state = game_state::waiting_input;
-
-
-static posix::ticks_t animation_begin_time{};
 static constexpr nuint animation_ms = 100;
-static table_t prev_table{};
-static movement_table_t movement_table;
\ No newline at end of file
+static game_t game { uint64(posix::get_ticks()) };
+
+/* games of the window are appended to it, with --replays <path> only */
+static replay_writer_t* replay_writer = nullptr;
+static replay_recorder_t replay_recorder{};
\ No newline at end of file
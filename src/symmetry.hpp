@@ -0,0 +1,92 @@
+#pragma once
+
+#include <integer.hpp>
+
+#include "./board.hpp"
+#include "./direction.hpp"
+
+/* [y][x] -> [y][3 - x] */
+constexpr board_t mirrored(board_t board) {
+	uint64 c = board.cells;
+	return board_t {
+		(c & 0x000F000F000F000FULL) << 12 |
+		(c & 0x00F000F000F000F0ULL) << 4  |
+		(c >> 4  & 0x00F000F000F000F0ULL) |
+		(c >> 12 & 0x000F000F000F000FULL)
+	};
+}
+
+/* [y][x] -> [3 - y][x] */
+constexpr board_t flipped(board_t board) {
+	uint64 c = board.cells;
+	return board_t {
+		c << 48 |
+		(c & 0x00000000FFFF0000ULL) << 16 |
+		(c >> 16 & 0x00000000FFFF0000ULL) |
+		c >> 48
+	};
+}
+
+/*
+ one of the 8 rotations and reflections of the board,
+ bits of value, applied in this order:
+ 4 - transpose, 2 - flip rows, 1 - mirror columns
+*/
+struct symmetry_t {
+	uint8 value = 0;
+
+	constexpr bool operator == (const symmetry_t&) const = default;
+
+	constexpr board_t apply(board_t board) const {
+		if (value & 4) board = board.transposed();
+		if (value & 2) board = flipped(board);
+		if (value & 1) board = mirrored(board);
+		return board;
+	}
+
+	/* direction on the transformed board that moves the same tiles as `dir` */
+	constexpr direction_t apply(direction_t dir) const {
+		uint8 d = dir.value;
+		if (value & 4) d ^= 2;
+		if (value & 2 && d < 2) d ^= 1;
+		if (value & 1 && d >= 2) d ^= 1;
+		return directions[d];
+	}
+
+	/* inverse of apply(direction_t), maps a move back to the original board */
+	constexpr direction_t revert(direction_t dir) const {
+		uint8 d = dir.value;
+		if (value & 1 && d >= 2) d ^= 1;
+		if (value & 2 && d < 2) d ^= 1;
+		if (value & 4) d ^= 2;
+		return directions[d];
+	}
+};
+
+struct canonical_board_t {
+	board_t board;
+	/* board = symmetry.apply(original) */
+	symmetry_t symmetry;
+};
+
+/*
+ representative of the board's symmetry class, the transform with
+ the smallest packed value. all 8 transforms of a board give the same
+ representative, so tables keyed by it store a class once
+*/
+constexpr canonical_board_t canonical(board_t board) {
+	board_t transposed = board.transposed();
+	board_t boards[8] {
+		board, mirrored(board), flipped(board), mirrored(flipped(board)),
+		transposed, mirrored(transposed),
+		flipped(transposed), mirrored(flipped(transposed))
+	};
+
+	canonical_board_t result { board, {} };
+	for (uint8 i = 1; i < 8; ++i) {
+		if (boards[i].cells < result.board.cells) {
+			result = { boards[i], { i } };
+		}
+	}
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/memory.hpp>
+
+#include "./file_magic.hpp"
+
+#if __MINGW32__
+#include "./read_file.hpp"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+enum class table_kind : uint32 {
+	ntuple_network = 1,
+	heuristic = 2
+};
+
+/*
+ start of every table file. the rest of the header is kind-specific,
+ the payload (weights, lookup table) starts at `payload_offset`,
+ aligned to 64 bytes, so it's used in place from the mapping
+*/
+struct table_file_header_t {
+	file_magic_t magic;
+	table_kind kind;
+	uint64 payload_offset;
+	uint64 payload_size;
+
+	static constexpr file_magic_t expected_magic {
+		{ '2', '0', '4', '8', 't', 'a', 'b', 'l' }, 1
+	};
+
+	static table_file_header_t of(
+		table_kind kind, uint64 payload_offset, uint64 payload_size
+	) {
+		return { expected_magic, kind, payload_offset, payload_size };
+	}
+
+	/* header of the `kind` and current version, payload within `file_size` */
+	bool valid(table_kind expected_kind, nuint file_size) const {
+		return
+			magic == expected_magic &&
+			kind == expected_kind &&
+			payload_offset % 64 == 0 &&
+			payload_offset <= file_size &&
+			payload_size == file_size - payload_offset;
+	}
+};
+
+/*
+ read-only view of a whole file, mapped with mmap, so processes
+ using the same table share its pages and opening doesn't depend on
+ its size. on windows the file is read into memory instead.
+ data is nullptr if the file couldn't be opened
+*/
+struct table_file_t {
+#if __MINGW32__
+	posix::memory<uint8> contents;
+#endif
+	const uint8* data = nullptr;
+	nuint size = 0;
+
+#if __MINGW32__
+	table_file_t(const char* path) :
+		contents { read_file(path) },
+		data { contents.iterator() },
+		size { contents.size() }
+	{}
+#else
+	table_file_t(const char* path) {
+		int fd = open(path, O_RDONLY);
+		if (fd < 0) return;
+
+		struct stat status;
+		if (fstat(fd, &status) == 0 && status.st_size > 0) {
+			void* mapping = mmap(
+				nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0
+			);
+			if (mapping != MAP_FAILED) {
+				data = (const uint8*) mapping;
+				size = status.st_size;
+			}
+		}
+		close(fd);
+	}
+#endif
+
+	table_file_t(const table_file_t&) = delete;
+	table_file_t& operator = (const table_file_t&) = delete;
+
+	~table_file_t() {
+#if !__MINGW32__
+		if (data != nullptr) munmap((void*) data, size);
+#endif
+	}
+
+	/* nullptr if the file doesn't start with a valid header of the kind */
+	const table_file_header_t* header(table_kind kind) const {
+		if (size < sizeof(table_file_header_t)) return nullptr;
+		auto h = (const table_file_header_t*) data;
+		return h->valid(kind, size) ? h : nullptr;
+	}
+};
\ No newline at end of file
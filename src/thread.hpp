@@ -0,0 +1,51 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/abort.hpp>
+
+#include <pthread.h>
+#if !__MINGW32__
+#include <unistd.h>
+#endif
+
+inline nuint hardware_threads() {
+#if __MINGW32__
+	int count = pthread_num_processors_np();
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return count > 0 ? nuint(count) : 1;
+}
+
+/* runs f(thread_index) on `count` threads, index 0 is the calling thread */
+inline void run_on_threads(nuint count, auto&& f) {
+	struct thread_arg_t {
+		decltype(&f) function;
+		nuint index;
+	};
+
+	if (count == 0) count = 1;
+
+	pthread_t threads[count];
+	thread_arg_t args[count];
+
+	for (nuint i = 1; i < count; ++i) {
+		args[i] = { &f, i };
+		int result = pthread_create(
+			&threads[i], nullptr,
+			+[](void* arg) -> void* {
+				thread_arg_t& thread_arg = *(thread_arg_t*) arg;
+				(*thread_arg.function)(thread_arg.index);
+				return nullptr;
+			},
+			&args[i]
+		);
+		if (result != 0) posix::abort();
+	}
+
+	f(nuint(0));
+
+	for (nuint i = 1; i < count; ++i) {
+		pthread_join(threads[i], nullptr);
+	}
+}
\ No newline at end of file
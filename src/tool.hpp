@@ -0,0 +1,76 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/time.hpp>
+
+#include <print/print.hpp>
+
+/* helpers shared by the command line tools */
+
+inline bool equals(const char* a, const char* b) {
+	while (*a != 0 && *a == *b) { ++a; ++b; }
+	return *a == *b;
+}
+
+/* decimal digits only */
+inline bool try_parse_number(const char* str, uint64& number) {
+	if (*str == 0) return false;
+	number = 0;
+	for (; *str != 0; ++str) {
+		if (*str < '0' || *str > '9') return false;
+		number = number * 10 + (*str - '0');
+	}
+	return true;
+}
+
+/*
+ "[-]<digits>[.<digits>]" at the start of [text, end),
+ `text` is moved past it
+*/
+template<typename Char>
+inline bool try_parse_float(const Char*& text, const Char* end, float& number) {
+	bool negative = text != end && *text == '-';
+	if (negative) ++text;
+
+	float value = 0.0F, scale = 0.0F;
+	bool digits = false;
+	for (; text != end && ((*text >= '0' && *text <= '9') || *text == '.'); ++text) {
+		if (*text == '.') {
+			if (scale != 0.0F) return false;
+			scale = 1.0F;
+			continue;
+		}
+		digits = true;
+		value = value * 10.0F + float(*text - '0');
+		scale *= 10.0F;
+	}
+	if (!digits) return false;
+	if (scale != 0.0F) value /= scale;
+	number = negative ? -value : value;
+	return true;
+}
+
+/* the whole string is a number, as above */
+inline bool try_parse_float(const char* str, float& number) {
+	const char* end = str;
+	while (*end != 0) ++end;
+	return try_parse_float(str, end, number) && str == end;
+}
+
+/* value / 10^digits as "<integer>.<digits>" */
+inline void print_fixed(uint64 value, nuint digits) {
+	uint64 scale = 1;
+	for (nuint i = 0; i < digits; ++i) scale *= 10;
+
+	print::out(value / scale, ".");
+	while (scale > 1) {
+		scale /= 10;
+		print::out(value / scale % 10);
+	}
+}
+
+/* at least one tick, so rates can be divided by it */
+inline double seconds_of(posix::ticks_t ticks) {
+	if (ticks == 0) ticks = 1;
+	return double(ticks) / double(posix::ticks_per_second);
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <integer.hpp>
+#include <posix/abort.hpp>
+#include <posix/memory.hpp>
+
+#include "./futex.hpp"
+
+#include <pthread.h>
+
+/*
+ threads that live as long as the pool and run one job at a time,
+ for work that's repeated often and is too short to start threads
+ for (run_on_threads), e.g. stepping environments
+*/
+struct worker_pool_t {
+	nuint count;
+	posix::memory<pthread_t> threads;
+
+	futex_word_t generation{};
+	futex_word_t remaining{};
+	bool stopping = false;
+
+	void (*job)(void* f, nuint index) = nullptr;
+	void* job_function = nullptr;
+
+	struct worker_arg_t {
+		worker_pool_t* pool;
+		nuint index;
+	};
+	posix::memory<worker_arg_t> args;
+
+	/* `count` threads including the calling one */
+	worker_pool_t(nuint count) :
+		count { count == 0 ? 1 : count },
+		threads { posix::allocate<pthread_t>(this->count) },
+		args { posix::allocate<worker_arg_t>(this->count) }
+	{
+		for (nuint i = 1; i < this->count; ++i) {
+			args.iterator()[i] = { this, i };
+			int result = pthread_create(
+				&threads.iterator()[i], nullptr,
+				+[](void* arg) -> void* {
+					worker_arg_t& worker = *(worker_arg_t*) arg;
+					worker.pool->work(worker.index);
+					return nullptr;
+				},
+				&args.iterator()[i]
+			);
+			if (result != 0) posix::abort();
+		}
+	}
+
+	worker_pool_t(const worker_pool_t&) = delete;
+
+	~worker_pool_t() {
+		__atomic_store_n(&stopping, true, __ATOMIC_RELEASE);
+		generation.add(1);
+		for (nuint i = 1; i < count; ++i) {
+			pthread_join(threads.iterator()[i], nullptr);
+		}
+	}
+
+	void work(nuint index) {
+		uint32 seen = 0;
+		while (true) {
+			seen = generation.wait_while(seen);
+			if (__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) return;
+
+			job(job_function, index);
+			remaining.add(-1);
+		}
+	}
+
+	/* runs f(index) for every index in [0, count), 0 on the calling thread */
+	void run(auto&& f) {
+		job = +[](void* function, nuint index) {
+			(*(decltype(&f)) function)(index);
+		};
+		job_function = (void*) &f;
+
+		remaining.store(count - 1);
+		generation.add(1);
+
+		f(nuint(0));
+
+		uint32 left;
+		while ((left = remaining.load()) != 0) {
+			remaining.wait_while(left);
+		}
+	}
+};
\ No newline at end of file
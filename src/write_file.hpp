@@ -0,0 +1,36 @@
+#pragma once
+
+#include <integer.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/* writes all `size` bytes, retrying short writes, false on an error */
+inline bool write_all(int fd, const void* data, nuint size) {
+	const uint8* bytes = (const uint8*) data;
+	while (size > 0) {
+		auto written = ::write(fd, bytes, size);
+		if (written <= 0) return false;
+		bytes += written;
+		size -= written;
+	}
+	return true;
+}
+
+/* replaces the file with `size` bytes, false on any error */
+inline bool write_file(const char* path, const uint8* data, nuint size) {
+#if __MINGW32__
+	int flags = O_WRONLY | O_CREAT | O_TRUNC | O_BINARY;
+#else
+	int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#endif
+	int fd = open(path, flags, 0644);
+	if (fd < 0) return false;
+
+	if (!write_all(fd, data, size)) {
+		close(fd);
+		return false;
+	}
+
+	return close(fd) == 0;
+}
\ No newline at end of file